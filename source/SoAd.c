@@ -34,12 +34,13 @@
 
 #if(SOAD_CFG_ENABLE_DEVELOPMENT_ERROR == STD_ON)
 #include "Det.h"
-#define SOAD_DET_ERROR(api, error) Det_ReportError(SOAD_MODULEID, SOAD_INSTANCEID, api, error)
+#define SOAD_DET_INSTANCE        (SoAd_Instance->instance_id)
+#define SOAD_DET_ERROR(api, error) Det_ReportError(SOAD_MODULEID, SOAD_DET_INSTANCE, api, error)
 #define SOAD_DET_CHECK_RET(check, api, error)        \
     do {                                             \
         if (!(check)) {                              \
             (void)Det_ReportError(SOAD_MODULEID      \
-                                , SOAD_INSTANCEID    \
+                                , SOAD_DET_INSTANCE  \
                                 , api                \
                                 , error);            \
             return E_NOT_OK;                         \
@@ -50,7 +51,7 @@
     do {                                             \
         if (!(check)) {                              \
             (void)Det_ReportError(SOAD_MODULEID      \
-                                , SOAD_INSTANCEID    \
+                                , SOAD_DET_INSTANCE  \
                                 , api                \
                                 , error);            \
             return;                                  \
@@ -60,32 +61,472 @@
 #else
 #define SOAD_DET_ERROR(api, error)
 #define SOAD_DET_CHECK_RET(check, api, error)
-#define SOAD_DET_CHECK_RET_0(check, api)
+#define SOAD_DET_CHECK_RET_0(check, api, error)
 #endif
 
-const SoAd_ConfigType * SoAd_Config = NULL_PTR;
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 0u)
+#define SOAD_ROUTING_ENABLED(groups, con)                                    \
+    (((groups) == 0u) || (((groups) & SOAD_CFG_ATOMIC_LOAD(&SoAd_Instance->routing[con])) != 0u))
+#else
+#define SOAD_ROUTING_ENABLED(groups, con) TRUE
+#endif
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+#define SOAD_MEAS_INC(field, count)                                          \
+    (SoAd_Instance->measurement[SOAD_CFG_GET_CORE_ID()].field += (uint32)(count))
+#else
+#define SOAD_MEAS_INC(field, count)
+#endif
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+#define SOAD_TRACE_ROUTE_NONE 0xffffu
+#define SOAD_TRACE_ENTER(point)                                              \
+    const uint32 trace_start = SoAd_Trace_Enter(SoAd_Instance, point)
+#define SOAD_TRACE_EXIT(point, con, route, len, res)                         \
+    SoAd_Trace_Exit(SoAd_Instance, point, trace_start, con, route, len, res)
+#define SOAD_TRACE_STATECHANGE(con, state)                                         \
+    SoAd_Trace_Record(SoAd_Instance, SOAD_TRACE_STATE, SOAD_CFG_TRACE_TIMESTAMP(), con      \
+                    , SOAD_TRACE_ROUTE_NONE, (uint16)(state), E_OK)
+#else
+#define SOAD_TRACE_ENTER(point)
+#define SOAD_TRACE_EXIT(point, con, route, len, res)
+#define SOAD_TRACE_STATECHANGE(con, state)
+#endif
+
+/** @brief Size of the PDU header, 4 bytes id followed by 4 bytes length */
+#define SOAD_PDUHEADER_SIZE 8u
+
+/** @brief Words of the remote address copy read by parallel transmits */
+#define SOAD_REMOTE_WORDS (sizeof(TcpIp_SockAddrStorageType) / sizeof(uint32))
+
+/**
+ * @brief Learned remote addresses stored at once
+ *
+ * Each connection learns at most one current remote, and reception
+ * briefly holds one more while a change may be reverted.
+ */
+#define SOAD_REMOTE_STORE_COUNT (((SOAD_CFG_CONNECTION_COUNT + 1u) < SOAD_CFG_REMOTE_COUNT) \
+                                ? (SOAD_CFG_CONNECTION_COUNT + 1u) : SOAD_CFG_REMOTE_COUNT)
+
+/**
+ * @brief Token bucket of a transmit shaper
+ *
+ * Sending is allowed while tokens are positive and charges the full
+ * length, so a PDU larger than the budget leaves a debt that holds
+ * back later transmissions until refilled.
+ */
+typedef struct {
+    sint32                    tokens;
+    uint32                    refill;             /**< main function cycle of last refill */
+} SoAd_TxShapeType;
 
 typedef struct {
     TcpIp_SocketIdType        socket_id;
-    TcpIp_SockAddrStorageType remote;
+    TcpIp_SocketIdType        socket_spare;       /**< bound socket kept for the next open */
+    boolean                   spare_failed;       /**< don't retry spare socket until next open attempt */
+    SoAd_RemoteIdType         remote;             /**< current remote, SOAD_REMOTEID_INVALID if none */
+#if(SOAD_CFG_CONCURRENT_TX == STD_ON)
+    uint32                    remote_seq;         /**< odd while remote_words is rewritten */
+    uint32                    remote_words[SOAD_REMOTE_WORDS]; /**< copy of the current remote for SoAd_IfTransmit */
+#endif
+    SoAd_RemoteIdType         remote_config;      /**< configured remote, held for reverts */
+    SoAd_SoConIdType          remote_prev;        /**< neighbours in remote holder list or group free list */
+    SoAd_SoConIdType          remote_next;
+    boolean                   remote_release;     /**< revert to configured remote once closed */
     SoAd_SoConStateType       state;
     boolean                   request_open;
     boolean                   request_close;
     boolean                   request_abort;
+    uint16                    retry_delay;        /**< current backoff of a failed open, 0 if none */
+    boolean                   addr_waiting;       /**< queued until local address is assigned */
+    SoAd_SoConIdType          addr_next;          /**< next connection waiting for same local address */
 
     const SoAd_SocketRouteType* rx_route;
     const SoAd_PduRouteType*    tx_route;
-    PduLengthType               tx_remain;
-    PduLengthType               tx_available;
-
+    uint32                      tx_remain;          /**< bytes left of the TP PDU, unused while streaming */
+    uint32                      tx_available;       /**< bytes the upper layer has ready */
+    boolean                     tx_stream;          /**< TP PDU of unknown length, ends when upper layer has nothing more */
+    uint8                       tx_header[SOAD_PDUHEADER_SIZE]; /**< PDU header of the TP PDU */
+    uint8                       tx_header_left;     /**< header bytes not yet copied to TcpIp */
+    SoAd_TxShapeType            tx_shape;
+    PduIdType                   if_head;            /**< oldest IF PDU held back by shaping, SOAD_PDUID_INVALID if none */
+    PduIdType                   if_tail;
+    uint16                      if_count;           /**< IF PDUs held */
+
+    SoAd_BufferIdType           rx_buffer;          /**< received data not yet accepted by upper layer */
+    uint32                      rx_unacked;         /**< consumed TCP bytes not yet reported with TcpIp_TcpReceived */
 } SoAd_SoConStatusType;
 
 typedef struct {
     TcpIp_SocketIdType        socket_id;
+    uint16                    retry_delay;        /**< current backoff of a failed open, 0 if none */
+    SoAd_SoConIdType          free;               /**< head of member connections with a wildcard remote */
+    SoAd_TxShapeType          tx_shape;
 } SoAd_SoGrpStatusType;
 
-SoAd_SoConStatusType       SoAd_SoConStatus[SOAD_CFG_CONNECTION_COUNT];
-SoAd_SoGrpStatusType       SoAd_SoGrpStatus[SOAD_CFG_CONNECTIONGROUP_COUNT];
+/**
+ * @brief Interned remote address
+ *
+ * Each distinct address is held once, so connections compare remotes
+ * by id. Slots are found by open addressing on the hash of the address.
+ * Configured remotes are referenced in place, learned ones are copied
+ * to the remote store.
+ */
+typedef struct {
+    const TcpIp_SockAddrType* addr;
+    SoAd_RemoteIdType         store;              /**< slot in the remote store, SOAD_REMOTEID_INVALID if configured */
+    uint16                    refs;               /**< holders of the id, 0 if free */
+    boolean                   used;               /**< in use or on the probe path of an entry in use */
+    boolean                   wildcard;           /**< address contains wildcards */
+    SoAd_SoConIdType          holders;            /**< head of connections using the address as remote */
+} SoAd_RemoteType;
+
+/**
+ * @brief Connections of each group, in compressed sparse row form
+ *
+ * Members of group g are members[first[g]] up to members[first[g + 1] - 1],
+ * in ascending connection id order.
+ */
+typedef struct {
+    SoAd_SoConIdType          first  [SOAD_CFG_CONNECTIONGROUP_COUNT + 1u];
+    SoAd_SoConIdType          members[SOAD_CFG_CONNECTION_COUNT];
+} SoAd_SoGrpMembersType;
+
+/**
+ * @brief Set of connections with pending work, each queued at most once
+ *
+ * Items are a ring starting at head, which only moves when the oldest
+ * is taken.
+ */
+typedef struct {
+    SoAd_SoConIdType          head;
+    SoAd_SoConIdType          count;
+    SoAd_SoConIdType          items [SOAD_CFG_CONNECTION_COUNT];
+    boolean                   member[SOAD_CFG_CONNECTION_COUNT];
+} SoAd_SoConListType;
+
+/**
+ * @brief Queue of online connections with pending transmit work in one priority class
+ */
+typedef struct {
+    SoAd_SoConIdType          head;
+    SoAd_SoConIdType          count;
+    SoAd_SoConIdType          items[SOAD_CFG_CONNECTION_COUNT];
+} SoAd_TxQueueType;
+
+/**
+ * @brief Strict priority transmit scheduler
+ *
+ * Each class is served in FIFO order, once per connection and main
+ * function. A lower class is only served after all higher classes,
+ * within the transmit budget of the cycle.
+ */
+typedef struct {
+    SoAd_TxQueueType          classes[SOAD_CFG_TX_PRIORITY_COUNT];
+    boolean                   queued [SOAD_CFG_CONNECTION_COUNT];
+} SoAd_TxScheduleType;
+
+
+/**
+ * @brief IF PDU with PDU header gathered by TcpIp through SoAd_CopyTxData
+ *
+ * The header and the payload of the caller are copied straight into
+ * the buffer of TcpIp, during the transmit call that passed no data.
+ */
+typedef struct {
+    SoAd_SoConIdType          connection;         /**< SOAD_SOCONID_INVALID if no transmit is ongoing */
+    uint8                     header[SOAD_PDUHEADER_SIZE];
+    uint8                     header_left;
+    const uint8*              data;
+    uint32                    data_left;
+} SoAd_IfGatherType;
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+/**
+ * @brief IF PDU held back by transmit shaping, at most one per PDU route
+ *
+ * A newer PDU replaces the held copy in place, keeping its position
+ * in the list of its connection.
+ */
+typedef struct {
+    const SoAd_PduRouteType*  route;
+    SoAd_BufferIdType         buffer;             /**< copy of the latest PDU, SOAD_BUFFERID_INVALID if none */
+    PduIdType                 next;               /**< next held PDU of the same connection */
+} SoAd_IfHeldType;
+#endif
+
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+/**
+ * @brief Part of a transmission not yet confirmed
+ *
+ * TCP bytes that need no confirmation, from TP PDUs or IF PDUs without
+ * confirmation, are kept in records without route, merged where adjacent.
+ */
+typedef struct {
+    const SoAd_PduRouteType*  route;              /**< IF route to confirm, NULL_PTR if none */
+    uint32                    length;             /**< bytes not yet acknowledged */
+} SoAd_InFlightRecordType;
+
+/**
+ * @brief Ring of unconfirmed transmissions of a connection, in transmit order
+ */
+typedef struct {
+    uint16                    head;
+    uint16                    count;
+    SoAd_InFlightRecordType   records[SOAD_CFG_TX_INFLIGHT_SIZE];
+} SoAd_InFlightType;
+
+#define SOAD_INFLIGHT_ROOM(id, route) SoAd_InFlight_Room(SoAd_Instance, id, route)
+#else
+#define SOAD_INFLIGHT_ROOM(id, route) TRUE
+#endif
+
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+typedef struct {
+    TcpIp_IpAddrStateType     state;
+    SoAd_SoConIdType          waiting;            /**< head of connections waiting for assignment */
+} SoAd_LocalAddrStatusType;
+#endif
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+typedef struct {
+    uint32                    offset;             /**< arena offset of first buffer in class */
+    SoAd_BufferIdType         first;              /**< id of first buffer in class */
+    SoAd_BufferIdType         free;               /**< head of free list */
+    uint16                    used;
+    uint16                    high_water;
+} SoAd_BufferClassStatusType;
+
+typedef struct {
+    SoAd_BufferIdType         next;               /**< next buffer in free list */
+    uint8                     size_class;
+    SoAd_SoConIdType          owner;
+    uint16                    length;             /**< number of valid bytes in buffer */
+} SoAd_BufferStatusType;
+
+typedef struct {
+    SoAd_BufferClassStatusType classes[SOAD_CFG_BUFFERCLASS_COUNT];
+    SoAd_BufferStatusType      buffers[SOAD_CFG_BUFFER_COUNT];
+    uint32                     con_used       [SOAD_CFG_CONNECTION_COUNT];
+    uint32                     con_high_water [SOAD_CFG_CONNECTION_COUNT];
+    uint32                     grp_used       [SOAD_CFG_CONNECTIONGROUP_COUNT];
+    uint32                     grp_high_water [SOAD_CFG_CONNECTIONGROUP_COUNT];
+    uint32                     alloc_failed;
+} SoAd_BufferPoolType;
+#endif
+
+/**
+ * @brief Timers of a connection
+ */
+typedef enum {
+    SOAD_TIMER_ALIVE,                   /**< UDP alive supervision */
+    SOAD_TIMER_TPTX,                    /**< TP transmit inactivity */
+    SOAD_TIMER_RETRY,                   /**< backoff of socket open */
+    SOAD_TIMER_SOCON_COUNT,
+} SoAd_TimerKindType;
+
+/**
+ * @brief Timers of a socket group
+ */
+typedef enum {
+    SOAD_TIMER_GRP_RETRY,               /**< backoff of group socket open */
+    SOAD_TIMER_SOGRP_COUNT,
+} SoAd_TimerGrpKindType;
+
+typedef uint16 SoAd_TimerIdType;
+
+#define SOAD_TIMERID_INVALID       (SoAd_TimerIdType)(-1)
+#define SOAD_TIMER_SOCON_TOTAL     (SOAD_CFG_CONNECTION_COUNT * SOAD_TIMER_SOCON_COUNT)
+#define SOAD_TIMER_COUNT           (SOAD_TIMER_SOCON_TOTAL + SOAD_CFG_CONNECTIONGROUP_COUNT * SOAD_TIMER_SOGRP_COUNT)
+#define SOAD_TIMER_ID(con, kind)   (SoAd_TimerIdType)((con) * SOAD_TIMER_SOCON_COUNT + (kind))
+#define SOAD_TIMER_GRP_ID(grp, kind) (SoAd_TimerIdType)(SOAD_TIMER_SOCON_TOTAL + (grp) * SOAD_TIMER_SOGRP_COUNT + (kind))
+
+#define SOAD_TIMER_SLOT_BITS       6u
+#define SOAD_TIMER_SLOT_COUNT      (1u << SOAD_TIMER_SLOT_BITS)
+#define SOAD_TIMER_SLOT_MASK       (SOAD_TIMER_SLOT_COUNT - 1u)
+#define SOAD_TIMER_LEVEL_COUNT     3u
+#define SOAD_TIMER_BUCKET_EXPIRING (uint8)(SOAD_TIMER_LEVEL_COUNT * SOAD_TIMER_SLOT_COUNT)
+#define SOAD_TIMER_BUCKET_INVALID  (uint8)(-1)
+
+typedef struct {
+    uint32                    expire;             /**< absolute main function tick of expiry */
+    SoAd_TimerIdType          next;
+    SoAd_TimerIdType          prev;
+    uint8                     bucket;             /**< level * slot count + slot, or invalid if not armed */
+} SoAd_TimerType;
+
+/**
+ * @brief Hierarchical timer wheel driven by the main function
+ *
+ * Level n has slots of 64^n ticks each. A timer is placed at the
+ * level that covers its remaining time, and moved down one level
+ * when the wheel below it wraps, so arming, cancelling and expiring
+ * are all O(1) independent of the number of connections.
+ */
+typedef struct {
+    uint32                    now;
+    SoAd_TimerIdType          buckets[SOAD_TIMER_LEVEL_COUNT * SOAD_TIMER_SLOT_COUNT + 1u];
+    SoAd_TimerType            timers [SOAD_TIMER_COUNT];
+} SoAd_TimerWheelType;
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+/**
+ * @brief Trace ring and histograms of one core
+ *
+ * Only the owning core writes. It announces the slot it is about to
+ * overwrite in claim and publishes the event by advancing head. Readers
+ * detect events overwritten while copying by re-reading claim.
+ */
+typedef struct {
+    volatile uint32                         head;       /**< events written since init */
+    volatile uint32                         claim;      /**< events started since init */
+    uint32                                  tail;       /**< events consumed by reader */
+    SoAd_TraceEventType                     events[SOAD_CFG_TRACE_SIZE];
+    SoAd_TraceHistogramType                 histograms[SOAD_TRACE_POINT_COUNT];
+} SoAd_TraceType;
+#endif
+
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+/**
+ * @brief Max slots searched for a remote address in the rate limiter
+ */
+#define SOAD_RATELIMIT_PROBES 4u
+
+typedef struct {
+    uint32                    addr[4];            /**< remote ip address, port is ignored */
+    TcpIp_DomainType          domain;             /**< 0 for a free slot */
+    SoAd_SoGrpIdType          group;
+    uint16                    tokens;
+    uint32                    refill;             /**< timer tick tokens were last added */
+    uint32                    seen;               /**< timer tick of last datagram */
+} SoAd_RateLimitEntryType;
+#endif
+
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+#define SOAD_ACCEPT_INVALID 0xffffu
+
+typedef struct {
+    uint16                    child[2];
+    uint16                    filter;             /**< first filter ending at this node */
+} SoAd_AcceptNodeType;
+
+/**
+ * @brief Binary prefix trie of acceptance filters, one per group and domain
+ */
+typedef struct {
+    SoAd_AcceptNodeType       nodes[SOAD_CFG_ACCEPTFILTER_NODES];
+    uint16                    used;
+    uint16                    next[SOAD_CFG_ACCEPTFILTER_COUNT];   /**< next filter ending at same node */
+    uint16                    root[SOAD_CFG_CONNECTIONGROUP_COUNT][2u];
+} SoAd_AcceptTrieType;
+#endif
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+typedef struct {
+    uint32                                  calls;
+    uint32                                  min;
+    uint32                                  max;
+    uint32                                  total;
+    uint32                                  exhausted;
+} SoAd_MainFunctionTimingType;
+#endif
+
+/**
+ * @brief State of one SoAd instance
+ *
+ * Every API acts on the instance selected for the calling context,
+ * see SoAd_SetInstance, or on the one passed to its *Instance variant.
+ */
+struct SoAd_InstanceType {
+    uint8                       instance_id;        /**< reported to Det */
+    const SoAd_ConfigType*      config;
+    SoAd_SoConStatusType        connections[SOAD_CFG_CONNECTION_COUNT];
+    SoAd_SoGrpStatusType        groups     [SOAD_CFG_CONNECTIONGROUP_COUNT];
+    SoAd_RemoteType             remotes    [SOAD_CFG_REMOTE_COUNT];
+    TcpIp_SockAddrStorageType   remote_store[SOAD_REMOTE_STORE_COUNT]; /**< learned remotes, domain 0 if free */
+    uint16                      remote_tombstones;  /**< free slots still marked used */
+    SoAd_SoGrpMembersType       members;
+    SoAd_SoConListType          rx_window;          /**< connections with consumed receive data to report to TcpIp */
+    SoAd_SoConListType          requests;           /**< connections with pending open or close requests */
+    SoAd_TxScheduleType         tx_schedule;
+    SoAd_SoConIdType            tx_copy;            /**< connection transmitting TP data, while TcpIp may call SoAd_CopyTxData for it */
+    uint32                      tx_copied;          /**< bytes TcpIp pulled for tx_copy, may be less than offered */
+    SoAd_IfGatherType           if_gather;
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    SoAd_IfHeldType             if_held    [SOAD_CFG_PDUROUTE_COUNT];
+#endif
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+    SoAd_InFlightType           inflight   [SOAD_CFG_CONNECTION_COUNT];
+    SoAd_SoConListType          inflight_list;      /**< connections with UDP transmissions to confirm from the main function */
+#else
+    const SoAd_PduRouteType*    if_confirm  [SOAD_CFG_PDUROUTE_COUNT];    /**< ring of routes with confirmations due, in order of first transmission */
+    uint16                      if_confirm_due[SOAD_CFG_PDUROUTE_COUNT];  /**< transmissions of each PDU not yet confirmed */
+    uint16                      if_confirm_head;
+    uint16                      if_confirm_count;
+#endif
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+    SoAd_SoConListType          modechg_list;       /**< connections with a mode change not yet reported, in order of first change */
+    SoAd_SoConModeChgEventType  modechg_events[SOAD_CFG_CONNECTION_COUNT];
+    SoAd_SoConModeChgEventType  modechg_upper [SOAD_CFG_CONNECTION_COUNT];
+#endif
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 0u)
+    SoAd_RoutingGroupMaskType   routing    [SOAD_CFG_CONNECTION_COUNT];   /**< routing groups enabled for each connection */
+    uint8                       iftrigger_buffer[SOAD_CFG_IFTRIGGER_SIZE];
+#endif
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+    SoAd_LocalAddrStatusType    localaddrs [SOAD_CFG_LOCALADDR_COUNT];
+#endif
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    SoAd_BufferPoolType         buffer_pool;
+    uint8                       buffer_arena[SOAD_CFG_BUFFER_ARENA_SIZE];
+#endif
+    SoAd_TimerWheelType         timer_wheel;
+    uint32                      random_state;
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+    SoAd_RateLimitEntryType     rate_limit [SOAD_CFG_RATELIMIT_COUNT];
+#endif
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+    SoAd_AcceptTrieType         accept_trie;
+#endif
+    SoAd_SoConIdType            mainfunction_cursor; /**< connection a budgeted main function resumes at, so all get serviced in turn */
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    SoAd_MainFunctionTimingType mainfunction_timing;
+    /* kept apart from the status structures, so the counters don't
+     * share cache lines with state used on every call */
+    SoAd_MeasurementDataType    measurement[SOAD_CFG_MEASUREMENT_CORE_COUNT];
+#endif
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+    SoAd_TraceType              trace      [SOAD_CFG_MEASUREMENT_CORE_COUNT];
+#endif
+};
+
+static SoAd_InstanceType   SoAd_DefaultInstance = { SOAD_INSTANCEID };
+
+#if(SOAD_CFG_INSTANCE_CORE_COUNT > 1u)
+/**
+ * @brief Instance each core works on, NULL_PTR until the core selects one
+ */
+static SOAD_CFG_INSTANCE_LOCAL SoAd_InstanceType* SoAd_Selected[SOAD_CFG_INSTANCE_CORE_COUNT];
+#define SOAD_INSTANCE_SELECTED      SoAd_Selected[SOAD_CFG_GET_CORE_ID()]
+#else
+/**
+ * @brief Instance the calling context works on, NULL_PTR for the default
+ */
+static SOAD_CFG_INSTANCE_LOCAL SoAd_InstanceType* SoAd_Selected;
+#define SOAD_INSTANCE_SELECTED      SoAd_Selected
+#endif
+
+/**
+ * @brief Instance the calling context works on
+ *
+ * Resolved once at the entry of each API, internal functions get it
+ * passed as SoAd_Instance.
+ */
+static SoAd_InstanceType* SoAd_Instance_Get(void)
+{
+    SoAd_InstanceType* instance = SOAD_INSTANCE_SELECTED;
+    return (instance != NULL_PTR) ? instance : &SoAd_DefaultInstance;
+}
 
 static const uint32 SoAd_Ip6Any[] = {
         TCPIP_IP6ADDR_ANY,
@@ -94,6 +535,14 @@ static const uint32 SoAd_Ip6Any[] = {
         TCPIP_IP6ADDR_ANY
 };
 
+static boolean SoAd_Ip6Equal(const uint32* a, const uint32* b)
+{
+    return ((a[0] == b[0])
+         && (a[1] == b[1])
+         && (a[2] == b[2])
+         && (a[3] == b[3])) ? TRUE : FALSE;
+}
+
 static void SoAd_SockAddrCopy(TcpIp_SockAddrStorageType* trg, const TcpIp_SockAddrType* src)
 {
     switch (src->domain) {
@@ -130,7 +579,7 @@ static boolean SoAd_SockAddrWildcard(const TcpIp_SockAddrType* addr)
             break;
         case TCPIP_AF_INET6: {
                 const TcpIp_SockAddrInet6Type* inet6 = (const TcpIp_SockAddrInet6Type*)addr;
-                if (memcmp(inet6->addr, SoAd_Ip6Any, sizeof(SoAd_Ip6Any)) == 0) {
+                if (SoAd_Ip6Equal(inet6->addr, SoAd_Ip6Any) == TRUE) {
                     res = TRUE;
                 }
 
@@ -173,8 +622,8 @@ static boolean SoAd_SockAddrWildcardMatch(const TcpIp_SockAddrType* addr_mask, c
                     const TcpIp_SockAddrInet6Type* inet_mask  = (const TcpIp_SockAddrInet6Type*)addr_mask;
                     const TcpIp_SockAddrInet6Type* inet_check = (const TcpIp_SockAddrInet6Type*)addr_check;
 
-                    if ((memcmp(SoAd_Ip6Any    , inet_check->addr, sizeof(inet_check->addr)) == sizeof(inet_check->addr))
-                    ||  (memcmp(inet_mask->addr, inet_check->addr, sizeof(inet_check->addr)) == sizeof(inet_check->addr))) {
+                    if ((SoAd_Ip6Equal(inet_mask->addr, SoAd_Ip6Any)      == TRUE)
+                    ||  (SoAd_Ip6Equal(inet_mask->addr, inet_check->addr) == TRUE)) {
                         if ((inet_mask->port    == TCPIP_PORT_ANY)
                         ||  (inet_mask->port    == inet_check->port)) {
                             res = TRUE;
@@ -183,591 +632,3413 @@ static boolean SoAd_SockAddrWildcardMatch(const TcpIp_SockAddrType* addr_mask, c
                 }
                 break;
             default:
-                res = E_NOT_OK;
                 break;
         }
-    } else {
-        res = E_NOT_OK;
     }
     return res;
 }
 
 
-static void SoAd_Init_SoCon(SoAd_SoConIdType id)
+/**
+ * @brief 32 bit fnv-1a over domain, port and address words
+ */
+static uint32 SoAd_Remote_Hash(const TcpIp_SockAddrType* addr, const uint32** words, uint8* count, uint16* port)
 {
-    const SoAd_SoConConfigType* config = SoAd_Config->connections[id];
-    SoAd_SoConStatusType*       status = &SoAd_SoConStatus[id];
+    uint32 hash = 2166136261u;
+    uint8  index;
 
-    memset(status, 0, sizeof(*status));
-    if (config->remote) {
-        SoAd_SockAddrCopy(&status->remote, config->remote);
-    } else {
-        status->remote.base.domain = (TcpIp_DomainType)0u;
+    switch (addr->domain) {
+        case TCPIP_AF_INET:
+            *words = ((const TcpIp_SockAddrInetType*)addr)->addr;
+            *port  = ((const TcpIp_SockAddrInetType*)addr)->port;
+            *count = 1u;
+            break;
+        case TCPIP_AF_INET6:
+            *words = ((const TcpIp_SockAddrInet6Type*)addr)->addr;
+            *port  = ((const TcpIp_SockAddrInet6Type*)addr)->port;
+            *count = 4u;
+            break;
+        default:
+            *words = NULL_PTR;
+            *port  = 0u;
+            *count = 0u;
+            break;
     }
-    status->socket_id = TCPIP_SOCKETID_INVALID;
 
-    /** @req SWS_SoAd_00723 */
-    status->state     = SOAD_SOCON_OFFLINE;
+    hash = (hash ^ addr->domain) * 16777619u;
+    hash = (hash ^ *port)        * 16777619u;
+    for (index = 0u; index < *count; ++index) {
+        hash = (hash ^ (*words)[index]) * 16777619u;
+    }
+    return hash;
 }
 
-static void SoAd_Init_SoGrp(SoAd_SoGrpIdType id)
+/**
+ * @brief Home slot of an address, where its probe sequence starts
+ */
+static SoAd_RemoteIdType SoAd_Remote_Home(const TcpIp_SockAddrType* addr)
 {
-    const SoAd_SoGrpConfigType* config = SoAd_Config->groups[id];
-    SoAd_SoGrpStatusType*       status = &SoAd_SoGrpStatus[id];
-    memset(status, 0, sizeof(*status));
-    status->socket_id = TCPIP_SOCKETID_INVALID;
+    const uint32* words;
+    uint8         count;
+    uint16        port;
+
+    return (SoAd_RemoteIdType)(SoAd_Remote_Hash(addr, &words, &count, &port) % SOAD_CFG_REMOTE_COUNT);
 }
 
-static Std_ReturnType SoAd_SoCon_Lookup(SoAd_SoConIdType *id, TcpIp_SocketIdType socket_id)
+static boolean SoAd_Remote_Equal(const SoAd_RemoteType* entry, const TcpIp_SockAddrType* addr, const uint32* words, uint8 count, uint16 port)
 {
-    Std_ReturnType   res = E_NOT_OK;
-    SoAd_SoConIdType index;
-    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
-        if (SoAd_SoConStatus[index].socket_id == socket_id) {
-            res = E_OK;
-            *id = index;
-            break;
+    boolean res = FALSE;
+    if (entry->addr->domain == addr->domain) {
+        if (count == 1u) {
+            const TcpIp_SockAddrInetType* inet = (const TcpIp_SockAddrInetType*)entry->addr;
+            res = ((inet->port    == port)
+                && (inet->addr[0] == words[0])) ? TRUE : FALSE;
+        } else {
+            const TcpIp_SockAddrInet6Type* inet6 = (const TcpIp_SockAddrInet6Type*)entry->addr;
+            res = ((inet6->port == port)
+                && (SoAd_Ip6Equal(inet6->addr, words) == TRUE)) ? TRUE : FALSE;
         }
     }
     return res;
 }
 
-static Std_ReturnType SoAd_SoGrp_Lookup(SoAd_SoGrpIdType *id, TcpIp_SocketIdType socket_id)
+/**
+ * @brief Find id of an interned remote address
+ * @return id of address, SOAD_REMOTEID_INVALID if not held by anyone
+ */
+static SoAd_RemoteIdType SoAd_Remote_Lookup(SoAd_InstanceType* SoAd_Instance, const TcpIp_SockAddrType* addr)
 {
-    Std_ReturnType   res = E_NOT_OK;
-    SoAd_SoConIdType index;
-    for (index = 0u; index < SOAD_CFG_CONNECTIONGROUP_COUNT; ++index) {
-        if (SoAd_SoGrpStatus[index].socket_id == socket_id) {
-            res = E_OK;
-            *id = index;
+    const uint32*     words;
+    uint8             count;
+    uint16            port;
+    uint32            hash = SoAd_Remote_Hash(addr, &words, &count, &port);
+    SoAd_RemoteIdType probe;
+    SoAd_RemoteIdType id;
+
+    if (count == 0u) {
+        return SOAD_REMOTEID_INVALID;
+    }
+
+    for (probe = 0u; probe < SOAD_CFG_REMOTE_COUNT; ++probe) {
+        id = (SoAd_RemoteIdType)(((hash % SOAD_CFG_REMOTE_COUNT) + probe) % SOAD_CFG_REMOTE_COUNT);
+        if (SoAd_Instance->remotes[id].used == FALSE) {
             break;
         }
+
+        if ((SoAd_Instance->remotes[id].refs != 0u)
+        &&  (SoAd_Remote_Equal(&SoAd_Instance->remotes[id], addr, words, count, port) == TRUE)) {
+            return id;
+        }
     }
-    return res;
+    return SOAD_REMOTEID_INVALID;
 }
 
-static Std_ReturnType SoAd_SoCon_Lookup_FreeSocket(
-        SoAd_SoConIdType*         id,
-        SoAd_SoGrpIdType          group,
-        const TcpIp_SockAddrType* remote
-    )
+/**
+ * @brief Intern a remote address and take a reference on it
+ * @param configured address lives as long as the configuration, so it is referenced in place
+ */
+static Std_ReturnType SoAd_Remote_Insert(SoAd_InstanceType* SoAd_Instance, const TcpIp_SockAddrType* addr, boolean configured, SoAd_RemoteIdType* id)
 {
-    Std_ReturnType   res = E_NOT_OK;
-    SoAd_SoConIdType index;
-    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
-        const SoAd_SoConConfigType* config = SoAd_Config->connections[index];
-        const SoAd_SoConStatusType* status = &SoAd_SoConStatus[index];
+    const uint32*     words;
+    uint8             count;
+    uint16            port;
+    uint32            hash;
+    SoAd_RemoteIdType probe;
+    SoAd_RemoteIdType index;
+    SoAd_RemoteIdType store = SOAD_REMOTEID_INVALID;
+
+    *id = SoAd_Remote_Lookup(SoAd_Instance, addr);
+    if (*id != SOAD_REMOTEID_INVALID) {
+        SoAd_Instance->remotes[*id].refs++;
+        return E_OK;
+    }
 
-        if (status->socket_id != TCPIP_SOCKETID_INVALID) {
-            continue;
+    hash = SoAd_Remote_Hash(addr, &words, &count, &port);
+    if (count == 0u) {
+        return E_NOT_OK;
+    }
+
+    if (configured == FALSE) {
+        for (store = 0u; store < SOAD_REMOTE_STORE_COUNT; ++store) {
+            if (SoAd_Instance->remote_store[store].base.domain == 0u) {
+                break;
+            }
         }
+        if (store == SOAD_REMOTE_STORE_COUNT) {
+            return E_NOT_OK;
+        }
+    }
 
-        if (status->state != SOAD_SOCON_OFFLINE) {
-            if (config->group == group) {
-                if (SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&status->remote, remote) == TRUE) {
-                    res = E_OK;
-                    *id = index;
-                    break;
-                }
+    for (probe = 0u; probe < SOAD_CFG_REMOTE_COUNT; ++probe) {
+        index = (SoAd_RemoteIdType)(((hash % SOAD_CFG_REMOTE_COUNT) + probe) % SOAD_CFG_REMOTE_COUNT);
+        if (SoAd_Instance->remotes[index].refs == 0u) {
+            SoAd_RemoteType* entry = &SoAd_Instance->remotes[index];
+            if (entry->used == TRUE) {
+                SoAd_Instance->remote_tombstones--;
+            }
+            if (configured == FALSE) {
+                SoAd_SockAddrCopy(&SoAd_Instance->remote_store[store], addr);
+                entry->addr = &SoAd_Instance->remote_store[store].base;
+            } else {
+                entry->addr = addr;
             }
+            entry->store    = store;
+            entry->refs     = 1u;
+            entry->used     = TRUE;
+            entry->wildcard = SoAd_SockAddrWildcard(addr);
+            entry->holders  = SOAD_SOCONID_INVALID;
+            *id = index;
+            return E_OK;
         }
     }
-    return res;
+    return E_NOT_OK;
 }
 
-static void SoAd_SoCon_EnterState(SoAd_SoConIdType id, SoAd_SoConStateType);
-
-void SoAd_Init(const SoAd_ConfigType* config)
+static Std_ReturnType SoAd_Remote_Acquire(SoAd_InstanceType* SoAd_Instance, const TcpIp_SockAddrType* addr, SoAd_RemoteIdType* id)
 {
-    uint16 id;
+    return SoAd_Remote_Insert(SoAd_Instance, addr, FALSE, id);
+}
 
-    SoAd_Config       = config;
+static void SoAd_Remote_Retain(SoAd_InstanceType* SoAd_Instance, SoAd_RemoteIdType id)
+{
+    if (id != SOAD_REMOTEID_INVALID) {
+        SoAd_Instance->remotes[id].refs++;
+    }
+}
 
+/**
+ * @brief Drop tombstones no longer on the probe path of any entry in use
+ *
+ * Entries stay in place since connections hold their ids, only the used
+ * marks are recomputed from the home slot of each entry in use.
+ */
+static void SoAd_Remote_Purge(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_RemoteIdType id;
+    SoAd_RemoteIdType index;
 
-    /** @req SWS_SoAd_00723 */
-    for (id = 0u; id < SOAD_CFG_CONNECTION_COUNT; ++id) {
-        SoAd_Init_SoCon(id);
+    for (id = 0u; id < SOAD_CFG_REMOTE_COUNT; ++id) {
+        if (SoAd_Instance->remotes[id].refs == 0u) {
+            SoAd_Instance->remotes[id].used = FALSE;
+        }
     }
+    SoAd_Instance->remote_tombstones = 0u;
 
-    for (id = 0u; id < SOAD_CFG_CONNECTIONGROUP_COUNT; ++id) {
-        SoAd_Init_SoGrp(id);
+    for (id = 0u; id < SOAD_CFG_REMOTE_COUNT; ++id) {
+        if (SoAd_Instance->remotes[id].refs == 0u) {
+            continue;
+        }
+
+        index = SoAd_Remote_Home(SoAd_Instance->remotes[id].addr);
+        while (index != id) {
+            if (SoAd_Instance->remotes[index].used == FALSE) {
+                SoAd_Instance->remotes[index].used = TRUE;
+                SoAd_Instance->remote_tombstones++;
+            }
+            index = (SoAd_RemoteIdType)((index + 1u) % SOAD_CFG_REMOTE_COUNT);
+        }
     }
 }
 
-static Std_ReturnType SoAd_GetSocketRoute(SoAd_SoConIdType con_id, uint32 header_id, SoAd_SocketRouteIdType* route_id)
+static void SoAd_Remote_Release(SoAd_InstanceType* SoAd_Instance, SoAd_RemoteIdType id)
 {
-    Std_ReturnType              res;
-    const SoAd_SoConConfigType* con_config = SoAd_Config->connections[con_id];
-    const SoAd_SoGrpConfigType* grp_config = SoAd_Config->groups[con_config->group];
+    if (id != SOAD_REMOTEID_INVALID) {
+        if (--SoAd_Instance->remotes[id].refs == 0u) {
+            if (SoAd_Instance->remotes[id].store != SOAD_REMOTEID_INVALID) {
+                SoAd_Instance->remote_store[SoAd_Instance->remotes[id].store].base.domain = 0u;
+            }
 
-    /* TODO - there can be multiple routes mapped to each connection */
-    if (con_config->socket_route_id != SOAD_SOCKETROUTEID_INVALID) {
-        *route_id = con_config->socket_route_id;
-        res = E_OK;
-    } else if (grp_config->socket_route_id < SOAD_SOCKETROUTEID_INVALID) {
-        *route_id = grp_config->socket_route_id;
-        res = E_OK;
-    } else {
-        res = E_NOT_OK;
+            /* purge once a quarter of the table only lengthens probes */
+            if (++SoAd_Instance->remote_tombstones > (SOAD_CFG_REMOTE_COUNT / 4u)) {
+                SoAd_Remote_Purge(SoAd_Instance);
+            }
+        }
     }
-    return res;
 }
 
-static Std_ReturnType SoAd_GetPduRoute(PduIdType id, const SoAd_PduRouteType** route)
+static const TcpIp_SockAddrType* SoAd_Remote_Address(SoAd_InstanceType* SoAd_Instance, SoAd_RemoteIdType id)
 {
-    Std_ReturnType res;
-    PduIdType      high = SOAD_CFG_PDUROUTE_COUNT - 1u;
-    PduIdType      low  = 0u;
+    return SoAd_Instance->remotes[id].addr;
+}
 
-    while (low < high) {
-        PduIdType mid = low + (PduIdType)((high - low) >> 1u);
-        if (SoAd_Config->pdu_routes[mid]->pdu_id < id) {
+static boolean SoAd_Remote_Wildcard(SoAd_InstanceType* SoAd_Instance, SoAd_RemoteIdType id)
+{
+    return (id != SOAD_REMOTEID_INVALID) ? SoAd_Instance->remotes[id].wildcard : FALSE;
+}
+
+/**
+ * @brief List a connection is linked into for its current remote
+ *
+ * A connection with an exact remote is found from the interned address,
+ * one with a wildcard remote from the free list of its group.
+ */
+static SoAd_SoConIdType* SoAd_SoCon_RemoteHead(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    SoAd_RemoteIdType remote = SoAd_Instance->connections[con_id].remote;
+
+    if (remote == SOAD_REMOTEID_INVALID) {
+        return NULL_PTR;
+    }
+
+    if (SoAd_Instance->remotes[remote].wildcard == TRUE) {
+        return &SoAd_Instance->groups[SoAd_Instance->config->connections[con_id]->group].free;
+    }
+    return &SoAd_Instance->remotes[remote].holders;
+}
+
+static void SoAd_SoCon_RemoteLink(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[con_id];
+    SoAd_SoConIdType*     head   = SoAd_SoCon_RemoteHead(SoAd_Instance, con_id);
+
+    status->remote_prev = SOAD_SOCONID_INVALID;
+    status->remote_next = SOAD_SOCONID_INVALID;
+    if (head) {
+        status->remote_next = *head;
+        if (*head != SOAD_SOCONID_INVALID) {
+            SoAd_Instance->connections[*head].remote_prev = con_id;
+        }
+        *head = con_id;
+    }
+}
+
+static void SoAd_SoCon_RemoteUnlink(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[con_id];
+    SoAd_SoConIdType*     head   = SoAd_SoCon_RemoteHead(SoAd_Instance, con_id);
+
+    if (head) {
+        if (status->remote_prev != SOAD_SOCONID_INVALID) {
+            SoAd_Instance->connections[status->remote_prev].remote_next = status->remote_next;
+        } else {
+            *head = status->remote_next;
+        }
+
+        if (status->remote_next != SOAD_SOCONID_INVALID) {
+            SoAd_Instance->connections[status->remote_next].remote_prev = status->remote_prev;
+        }
+    }
+}
+
+#if(SOAD_CFG_CONCURRENT_TX == STD_ON)
+/**
+ * @brief Copy the current remote of a connection for parallel transmits
+ *
+ * Writer side of a sequence lock, only called from the control context.
+ */
+static void SoAd_SoCon_PublishRemote(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[con_id];
+    uint32                words[SOAD_REMOTE_WORDS];
+    uint32                seq    = status->remote_seq;
+    uint16                index;
+    TcpIp_SockAddrStorageType remote;
+
+    memset(&remote, 0, sizeof(remote));
+    if (status->remote != SOAD_REMOTEID_INVALID) {
+        SoAd_SockAddrCopy(&remote, SoAd_Instance->remotes[status->remote].addr);
+    }
+    memcpy(words, &remote, sizeof(words));
+
+    SOAD_CFG_ATOMIC_STORE_RELAXED(&status->remote_seq, seq + 1u);
+    SOAD_CFG_ATOMIC_FENCE_RELEASE();
+    for (index = 0u; index < SOAD_REMOTE_WORDS; ++index) {
+        SOAD_CFG_ATOMIC_STORE_RELAXED(&status->remote_words[index], words[index]);
+    }
+    SOAD_CFG_ATOMIC_STORE(&status->remote_seq, seq + 2u);
+}
+
+/**
+ * @brief Read a consistent copy of the current remote of a connection
+ */
+static void SoAd_SoCon_ReadRemote(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, TcpIp_SockAddrStorageType* remote)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[con_id];
+    uint32                words[SOAD_REMOTE_WORDS];
+    uint32                seq;
+    uint16                index;
+
+    do {
+        seq = SOAD_CFG_ATOMIC_LOAD(&status->remote_seq);
+        for (index = 0u; index < SOAD_REMOTE_WORDS; ++index) {
+            words[index] = SOAD_CFG_ATOMIC_LOAD_RELAXED(&status->remote_words[index]);
+        }
+        SOAD_CFG_ATOMIC_FENCE_ACQUIRE();
+    } while (((seq & 1u) != 0u) || (seq != SOAD_CFG_ATOMIC_LOAD_RELAXED(&status->remote_seq)));
+
+    memcpy(remote, words, sizeof(words));
+}
+#else
+#define SoAd_SoCon_PublishRemote(instance, con_id)
+#endif
+
+/**
+ * @brief Replace the current remote of a connection, id must already be held by caller
+ */
+static void SoAd_SoCon_SetRemote(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, SoAd_RemoteIdType id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[con_id];
+    SoAd_SoCon_RemoteUnlink(SoAd_Instance, con_id);
+    SoAd_Remote_Release(SoAd_Instance, status->remote);
+    status->remote = id;
+    SoAd_SoCon_RemoteLink(SoAd_Instance, con_id);
+    SoAd_SoCon_PublishRemote(SoAd_Instance, con_id);
+}
+
+/**
+ * @brief Find the connection of a group that has an exact remote assigned
+ */
+static SoAd_SoConIdType SoAd_SoGrp_LookupRemote(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, SoAd_RemoteIdType remote)
+{
+    SoAd_SoConIdType id;
+
+    if ((remote == SOAD_REMOTEID_INVALID) || (SoAd_Instance->remotes[remote].wildcard == TRUE)) {
+        return SOAD_SOCONID_INVALID;
+    }
+
+    /* a remote is held by at most one connection per group it talks to */
+    for (id = SoAd_Instance->remotes[remote].holders; id != SOAD_SOCONID_INVALID; id = SoAd_Instance->connections[id].remote_next) {
+        if (SoAd_Instance->config->connections[id]->group == id_grp) {
+            break;
+        }
+    }
+    return id;
+}
+
+static Std_ReturnType SoAd_Init_SoCon(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id];
+
+    memset(status, 0, sizeof(*status));
+    status->remote_config = SOAD_REMOTEID_INVALID;
+    if (config->remote) {
+        if (SoAd_Remote_Insert(SoAd_Instance, config->remote, TRUE, &status->remote_config) != E_OK) {
+            return E_NOT_OK;
+        }
+    }
+    status->remote = status->remote_config;
+    SoAd_Remote_Retain(SoAd_Instance, status->remote);
+    SoAd_SoCon_RemoteLink(SoAd_Instance, id);
+    SoAd_SoCon_PublishRemote(SoAd_Instance, id);
+    status->socket_id = TCPIP_SOCKETID_INVALID;
+    status->socket_spare = TCPIP_SOCKETID_INVALID;
+    status->rx_buffer = SOAD_BUFFERID_INVALID;
+    status->addr_next = SOAD_SOCONID_INVALID;
+    status->if_head   = SOAD_PDUID_INVALID;
+    status->if_tail   = SOAD_PDUID_INVALID;
+    status->tx_shape.tokens = (sint32)config->tx_shape.burst;
+    status->tx_shape.refill = SoAd_Instance->timer_wheel.now;
+
+    /** @req SWS_SoAd_00723 */
+    status->state     = SOAD_SOCON_OFFLINE;
+
+    if ((config->tx_shape.rate != 0u) && (config->tx_shape.period == 0u)) {
+        return E_NOT_OK;
+    }
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_OFF)
+    /* held PDUs are copied to pool buffers */
+    if (config->if_retry != 0u) {
+        return E_NOT_OK;
+    }
+#endif
+    return E_OK;
+}
+
+static void SoAd_SoConList_Init(SoAd_SoConListType* list)
+{
+    memset(list, 0, sizeof(*list));
+}
+
+static void SoAd_SoConList_Push(SoAd_SoConListType* list, SoAd_SoConIdType id)
+{
+    if (list->member[id] == FALSE) {
+        list->member[id] = TRUE;
+        list->items[(list->head + list->count) % SOAD_CFG_CONNECTION_COUNT] = id;
+        list->count++;
+    }
+}
+
+static boolean SoAd_SoConList_Pop(SoAd_SoConListType* list, SoAd_SoConIdType* id)
+{
+    boolean res = FALSE;
+    if (list->count > 0u) {
+        list->count--;
+        *id               = list->items[(list->head + list->count) % SOAD_CFG_CONNECTION_COUNT];
+        list->member[*id] = FALSE;
+        res               = TRUE;
+    }
+    return res;
+}
+
+/**
+ * @brief Take the connection queued longest ago
+ */
+static boolean SoAd_SoConList_PopOldest(SoAd_SoConListType* list, SoAd_SoConIdType* id)
+{
+    boolean res = FALSE;
+    if (list->count > 0u) {
+        *id               = list->items[list->head];
+        list->member[*id] = FALSE;
+        list->head        = (SoAd_SoConIdType)((list->head + 1u) % SOAD_CFG_CONNECTION_COUNT);
+        list->count--;
+        res               = TRUE;
+    }
+    return res;
+}
+
+/**
+ * @brief Queue a connection for transmit scheduling if it has work and can send
+ */
+static void SoAd_TxSchedule_Push(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+    SoAd_TxQueueType*           queue;
+    uint8                       prio;
+
+    if ((SoAd_Instance->tx_schedule.queued[id] == TRUE)
+    ||  ((status->tx_route == NULL_PTR) && (status->if_head == SOAD_PDUID_INVALID))
+    ||  (status->state != SOAD_SOCON_ONLINE)) {
+        return;
+    }
+
+    /* a route is served no higher than the class of its connection */
+    if (status->tx_route != NULL_PTR) {
+        prio = status->tx_route->priority;
+    } else {
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+        prio = SoAd_Instance->if_held[status->if_head].route->priority;
+#else
+        prio = 0u;
+#endif
+    }
+    if (SoAd_Instance->config->connections[id]->tx_priority > prio) {
+        prio = SoAd_Instance->config->connections[id]->tx_priority;
+    }
+    if (prio >= SOAD_CFG_TX_PRIORITY_COUNT) {
+        prio = SOAD_CFG_TX_PRIORITY_COUNT - 1u;
+    }
+
+    queue = &SoAd_Instance->tx_schedule.classes[prio];
+    queue->items[(queue->head + queue->count) % SOAD_CFG_CONNECTION_COUNT] = id;
+    queue->count++;
+    SoAd_Instance->tx_schedule.queued[id] = TRUE;
+}
+
+static SoAd_SoConIdType SoAd_TxSchedule_Pop(SoAd_InstanceType* SoAd_Instance, SoAd_TxQueueType* queue)
+{
+    SoAd_SoConIdType id = queue->items[queue->head];
+
+    queue->head = (SoAd_SoConIdType)((queue->head + 1u) % SOAD_CFG_CONNECTION_COUNT);
+    queue->count--;
+    SoAd_Instance->tx_schedule.queued[id] = FALSE;
+    return id;
+}
+
+/**
+ * @brief Build group membership index with a counting sort over connections
+ */
+static Std_ReturnType SoAd_Init_SoGrpMembers(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_SoGrpMembersType* index = &SoAd_Instance->members;
+    SoAd_SoConIdType       fill[SOAD_CFG_CONNECTIONGROUP_COUNT];
+    SoAd_SoConIdType       id_con;
+    SoAd_SoGrpIdType       id_grp;
+
+    memset(index, 0, sizeof(*index));
+    for (id_con = 0u; id_con < SOAD_CFG_CONNECTION_COUNT; ++id_con) {
+        id_grp = SoAd_Instance->config->connections[id_con]->group;
+        if (id_grp >= SOAD_CFG_CONNECTIONGROUP_COUNT) {
+            return E_NOT_OK;
+        }
+        index->first[id_grp + 1u]++;
+    }
+
+    for (id_grp = 0u; id_grp < SOAD_CFG_CONNECTIONGROUP_COUNT; ++id_grp) {
+        index->first[id_grp + 1u] += index->first[id_grp];
+        fill[id_grp]               = index->first[id_grp];
+    }
+
+    for (id_con = 0u; id_con < SOAD_CFG_CONNECTION_COUNT; ++id_con) {
+        id_grp = SoAd_Instance->config->connections[id_con]->group;
+        index->members[fill[id_grp]++] = id_con;
+    }
+    return E_OK;
+}
+
+static Std_ReturnType SoAd_Init_SoGrp(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id)
+{
+    const SoAd_SoGrpConfigType* config = SoAd_Instance->config->groups[id];
+    SoAd_SoGrpStatusType*       status = &SoAd_Instance->groups[id];
+    memset(status, 0, sizeof(*status));
+    status->socket_id = TCPIP_SOCKETID_INVALID;
+    status->free      = SOAD_SOCONID_INVALID;
+    status->tx_shape.tokens = (sint32)config->tx_shape.burst;
+    status->tx_shape.refill = SoAd_Instance->timer_wheel.now;
+
+    if ((config->tx_shape.rate != 0u) && (config->tx_shape.period == 0u)) {
+        return E_NOT_OK;
+    }
+
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+    if ((config->rx_limit.rate != 0u) && (config->rx_limit.period == 0u)) {
+        return E_NOT_OK;
+    }
+#endif
+    return E_OK;
+}
+
+static void SoAd_Init_Timer(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_TimerIdType id;
+    uint16           index;
+
+    SoAd_Instance->timer_wheel.now = 0u;
+    SoAd_Instance->random_state    = 0x2545F491u;
+    for (index = 0u; index <= SOAD_TIMER_BUCKET_EXPIRING; ++index) {
+        SoAd_Instance->timer_wheel.buckets[index] = SOAD_TIMERID_INVALID;
+    }
+
+    for (id = 0u; id < SOAD_TIMER_COUNT; ++id) {
+        SoAd_Instance->timer_wheel.timers[id].bucket = SOAD_TIMER_BUCKET_INVALID;
+    }
+}
+
+static void SoAd_Timer_Link(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id)
+{
+    SoAd_TimerType* timer = &SoAd_Instance->timer_wheel.timers[id];
+    uint32          delta = timer->expire - SoAd_Instance->timer_wheel.now;
+    uint8           level;
+    uint8           bucket;
+
+    for (level = 0u; level < SOAD_TIMER_LEVEL_COUNT - 1u; ++level) {
+        if (delta < (1uL << (SOAD_TIMER_SLOT_BITS * (level + 1u)))) {
+            break;
+        }
+    }
+
+    bucket = (uint8)(level * SOAD_TIMER_SLOT_COUNT
+           + ((timer->expire >> (SOAD_TIMER_SLOT_BITS * level)) & SOAD_TIMER_SLOT_MASK));
+
+    timer->bucket = bucket;
+    timer->prev   = SOAD_TIMERID_INVALID;
+    timer->next   = SoAd_Instance->timer_wheel.buckets[bucket];
+    if (timer->next != SOAD_TIMERID_INVALID) {
+        SoAd_Instance->timer_wheel.timers[timer->next].prev = id;
+    }
+    SoAd_Instance->timer_wheel.buckets[bucket] = id;
+}
+
+static void SoAd_Timer_Cancel(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id)
+{
+    SoAd_TimerType* timer = &SoAd_Instance->timer_wheel.timers[id];
+
+    if (timer->bucket == SOAD_TIMER_BUCKET_INVALID) {
+        return;
+    }
+
+    if (timer->prev != SOAD_TIMERID_INVALID) {
+        SoAd_Instance->timer_wheel.timers[timer->prev].next = timer->next;
+    } else {
+        SoAd_Instance->timer_wheel.buckets[timer->bucket] = timer->next;
+    }
+
+    if (timer->next != SOAD_TIMERID_INVALID) {
+        SoAd_Instance->timer_wheel.timers[timer->next].prev = timer->prev;
+    }
+    timer->bucket = SOAD_TIMER_BUCKET_INVALID;
+}
+
+/**
+ * @brief (Re)start a timer to expire after a number of main function ticks
+ */
+static void SoAd_Timer_Arm(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id, uint32 ticks)
+{
+    const uint32 ticks_max = (1uL << (SOAD_TIMER_SLOT_BITS * SOAD_TIMER_LEVEL_COUNT)) - 1u;
+
+    if (ticks == 0u) {
+        ticks = 1u;
+    } else if (ticks > ticks_max) {
+        ticks = ticks_max;
+    }
+
+    SoAd_Timer_Cancel(SoAd_Instance, id);
+    SoAd_Instance->timer_wheel.timers[id].expire = SoAd_Instance->timer_wheel.now + ticks;
+    SoAd_Timer_Link(SoAd_Instance, id);
+}
+
+static boolean SoAd_Timer_Active(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id)
+{
+    return SoAd_Instance->timer_wheel.timers[id].bucket != SOAD_TIMER_BUCKET_INVALID;
+}
+
+/**
+ * @brief Cheap pseudo random number for retry jitter (xorshift32)
+ */
+static uint32 SoAd_Random(SoAd_InstanceType* SoAd_Instance)
+{
+    uint32 x = SoAd_Instance->random_state;
+    x ^= x << 13u;
+    x ^= x >> 17u;
+    x ^= x << 5u;
+    SoAd_Instance->random_state = x;
+    return x;
+}
+
+/**
+ * @brief Arm a retry timer with the next delay of an exponential backoff
+ */
+static void SoAd_Retry_Arm(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id, const SoAd_RetryConfigType* config, uint16* delay)
+{
+    uint32 max = (config->max != 0u ? config->max : 0xffffu);
+    uint32 next;
+
+    if (config->initial == 0u) {
+        return;
+    }
+
+    if (*delay == 0u) {
+        next = config->initial;
+    } else {
+        next = (uint32)*delay * (config->multiplier ? config->multiplier : 1u);
+    }
+
+    if (next > max) {
+        next = max;
+    }
+    *delay = (uint16)next;
+
+    if (config->jitter != 0u) {
+        next += SoAd_Random(SoAd_Instance) % ((uint32)config->jitter + 1u);
+    }
+    SoAd_Timer_Arm(SoAd_Instance, id, next);
+}
+
+/**
+ * @brief Move all timers of a higher level slot down to lower levels
+ */
+static void SoAd_Timer_Cascade(SoAd_InstanceType* SoAd_Instance, uint8 bucket)
+{
+    SoAd_TimerIdType id = SoAd_Instance->timer_wheel.buckets[bucket];
+
+    SoAd_Instance->timer_wheel.buckets[bucket] = SOAD_TIMERID_INVALID;
+    while (id != SOAD_TIMERID_INVALID) {
+        SoAd_TimerIdType next = SoAd_Instance->timer_wheel.timers[id].next;
+        SoAd_Timer_Link(SoAd_Instance, id);
+        id = next;
+    }
+}
+
+static void SoAd_Timer_Expired(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id);
+
+/**
+ * @brief Advance time one main function tick and expire due timers
+ */
+static void SoAd_Timer_Tick(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_TimerIdType id;
+    uint8            level;
+    uint32           now = ++SoAd_Instance->timer_wheel.now;
+
+    for (level = 1u; level < SOAD_TIMER_LEVEL_COUNT; ++level) {
+        if ((now & ((1uL << (SOAD_TIMER_SLOT_BITS * level)) - 1u)) != 0u) {
+            break;
+        }
+    }
+
+    while (--level > 0u) {
+        SoAd_Timer_Cascade(SoAd_Instance, (uint8)(level * SOAD_TIMER_SLOT_COUNT
+                         + ((now >> (SOAD_TIMER_SLOT_BITS * level)) & SOAD_TIMER_SLOT_MASK)));
+    }
+
+    /*
+     * move the due slot to the expiring list, so handlers can safely
+     * cancel or re-arm any timer, including those not yet handled
+     */
+    SoAd_Instance->timer_wheel.buckets[SOAD_TIMER_BUCKET_EXPIRING] = SoAd_Instance->timer_wheel.buckets[now & SOAD_TIMER_SLOT_MASK];
+    SoAd_Instance->timer_wheel.buckets[now & SOAD_TIMER_SLOT_MASK] = SOAD_TIMERID_INVALID;
+    for (id  = SoAd_Instance->timer_wheel.buckets[SOAD_TIMER_BUCKET_EXPIRING];
+         id != SOAD_TIMERID_INVALID;
+         id  = SoAd_Instance->timer_wheel.timers[id].next) {
+        SoAd_Instance->timer_wheel.timers[id].bucket = SOAD_TIMER_BUCKET_EXPIRING;
+    }
+
+    while (SoAd_Instance->timer_wheel.buckets[SOAD_TIMER_BUCKET_EXPIRING] != SOAD_TIMERID_INVALID) {
+        id = SoAd_Instance->timer_wheel.buckets[SOAD_TIMER_BUCKET_EXPIRING];
+        SoAd_Timer_Cancel(SoAd_Instance, id);
+        SoAd_Timer_Expired(SoAd_Instance, id);
+    }
+}
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+/**
+ * @brief Lay out all size classes over the buffer arena
+ *
+ * Each class is a contiguous run of equally sized buffers, linked
+ * together in a free list, so allocation and release are O(1).
+ */
+static Std_ReturnType SoAd_Init_Buffer(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_BufferPoolType* pool   = &SoAd_Instance->buffer_pool;
+    uint32               offset = 0u;
+    SoAd_BufferIdType    id     = 0u;
+    uint8                index;
+
+    memset(pool, 0, sizeof(*pool));
+
+    for (index = 0u; index < SOAD_CFG_BUFFERCLASS_COUNT; ++index) {
+        const SoAd_BufferClassType* config = SoAd_Instance->config->buffer_classes[index];
+        SoAd_BufferClassStatusType* status = &pool->classes[index];
+        uint16                      count;
+
+        if ((offset + (uint32)config->size * config->count > SOAD_CFG_BUFFER_ARENA_SIZE)
+        ||  ((uint32)id + config->count > SOAD_CFG_BUFFER_COUNT)) {
+            return E_NOT_OK;
+        }
+
+        status->offset = offset;
+        status->first  = id;
+        status->free   = (config->count ? id : SOAD_BUFFERID_INVALID);
+
+        for (count = 0u; count < config->count; ++count, ++id) {
+            pool->buffers[id].size_class = index;
+            pool->buffers[id].next       = (count + 1u < config->count ? id + 1u : SOAD_BUFFERID_INVALID);
+        }
+        offset += (uint32)config->size * config->count;
+    }
+    return E_OK;
+}
+
+static uint8* SoAd_Buffer_Data(SoAd_InstanceType* SoAd_Instance, SoAd_BufferIdType id)
+{
+    const SoAd_BufferStatusType*      buffer = &SoAd_Instance->buffer_pool.buffers[id];
+    const SoAd_BufferClassStatusType* status = &SoAd_Instance->buffer_pool.classes[buffer->size_class];
+    const SoAd_BufferClassType*       config = SoAd_Instance->config->buffer_classes[buffer->size_class];
+
+    return &SoAd_Instance->buffer_arena[status->offset + (uint32)config->size * (id - status->first)];
+}
+
+static uint16 SoAd_Buffer_Size(SoAd_InstanceType* SoAd_Instance, SoAd_BufferIdType id)
+{
+    return SoAd_Instance->config->buffer_classes[SoAd_Instance->buffer_pool.buffers[id].size_class]->size;
+}
+
+/**
+ * @brief Allocate a buffer of at least size bytes on behalf of a connection
+ *
+ * The smallest class with a free buffer is used. Allocation fails if
+ * it would exceed the quota of the connection or its group.
+ */
+static Std_ReturnType SoAd_Buffer_Alloc(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id_con, uint32 size, SoAd_BufferIdType* id)
+{
+    SoAd_BufferPoolType*        pool       = &SoAd_Instance->buffer_pool;
+    const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[id_con];
+    const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+    SoAd_BufferClassStatusType* status     = NULL_PTR;
+    uint32                      bytes      = 0u;
+    uint8                       index;
+
+    for (index = 0u; index < SOAD_CFG_BUFFERCLASS_COUNT; ++index) {
+        bytes = SoAd_Instance->config->buffer_classes[index]->size;
+        if ((bytes >= size) && (pool->classes[index].free != SOAD_BUFFERID_INVALID)) {
+            status = &pool->classes[index];
+            break;
+        }
+    }
+
+    if ((status == NULL_PTR)
+    ||  ((con_config->buffer_quota != 0u) && (pool->con_used[id_con] + bytes > con_config->buffer_quota))
+    ||  ((grp_config->buffer_quota != 0u) && (pool->grp_used[con_config->group] + bytes > grp_config->buffer_quota))) {
+        pool->alloc_failed++;
+        return E_NOT_OK;
+    }
+
+    *id          = status->free;
+    status->free = pool->buffers[*id].next;
+    pool->buffers[*id].next   = SOAD_BUFFERID_INVALID;
+    pool->buffers[*id].owner  = id_con;
+    pool->buffers[*id].length = 0u;
+
+    if (++status->used > status->high_water) {
+        status->high_water = status->used;
+    }
+
+    pool->con_used[id_con] += bytes;
+    if (pool->con_used[id_con] > pool->con_high_water[id_con]) {
+        pool->con_high_water[id_con] = pool->con_used[id_con];
+    }
+
+    pool->grp_used[con_config->group] += bytes;
+    if (pool->grp_used[con_config->group] > pool->grp_high_water[con_config->group]) {
+        pool->grp_high_water[con_config->group] = pool->grp_used[con_config->group];
+    }
+    return E_OK;
+}
+
+static void SoAd_Buffer_Free(SoAd_InstanceType* SoAd_Instance, SoAd_BufferIdType id)
+{
+    SoAd_BufferPoolType*        pool   = &SoAd_Instance->buffer_pool;
+    SoAd_BufferStatusType*      buffer = &pool->buffers[id];
+    SoAd_BufferClassStatusType* status = &pool->classes[buffer->size_class];
+    uint32                      bytes  = SoAd_Buffer_Size(SoAd_Instance, id);
+
+    pool->con_used[buffer->owner] -= bytes;
+    pool->grp_used[SoAd_Instance->config->connections[buffer->owner]->group] -= bytes;
+
+    buffer->next = status->free;
+    status->free = id;
+    status->used--;
+}
+
+/**
+ * @brief Append data to a connection owned buffer, allocating or growing it as needed
+ */
+static Std_ReturnType SoAd_Buffer_Append(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id_con, SoAd_BufferIdType* id, const uint8* data, uint16 len)
+{
+    SoAd_BufferIdType prev   = *id;
+    uint16            length = 0u;
+
+    if (prev != SOAD_BUFFERID_INVALID) {
+        length = SoAd_Instance->buffer_pool.buffers[prev].length;
+        if ((uint32)length + len <= SoAd_Buffer_Size(SoAd_Instance, prev)) {
+            memcpy(SoAd_Buffer_Data(SoAd_Instance, prev) + length, data, len);
+            SoAd_Instance->buffer_pool.buffers[prev].length = length + len;
+            return E_OK;
+        }
+    }
+
+    if (SoAd_Buffer_Alloc(SoAd_Instance, id_con, (uint32)length + len, id) != E_OK) {
+        *id = prev;
+        return E_NOT_OK;
+    }
+
+    if (prev != SOAD_BUFFERID_INVALID) {
+        memcpy(SoAd_Buffer_Data(SoAd_Instance, *id), SoAd_Buffer_Data(SoAd_Instance, prev), length);
+        SoAd_Buffer_Free(SoAd_Instance, prev);
+    }
+    memcpy(SoAd_Buffer_Data(SoAd_Instance, *id) + length, data, len);
+    SoAd_Instance->buffer_pool.buffers[*id].length = length + len;
+    return E_OK;
+}
+#endif
+
+static Std_ReturnType SoAd_SoCon_Lookup(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType *id, TcpIp_SocketIdType socket_id)
+{
+    Std_ReturnType   res = E_NOT_OK;
+    SoAd_SoConIdType index;
+    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
+        if (SoAd_Instance->connections[index].socket_id == socket_id) {
+            res = E_OK;
+            *id = index;
+            break;
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Find the connection keeping a socket as its spare
+ */
+static Std_ReturnType SoAd_SoCon_LookupSpare(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType *id, TcpIp_SocketIdType socket_id)
+{
+    Std_ReturnType   res = E_NOT_OK;
+    SoAd_SoConIdType index;
+    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
+        if (SoAd_Instance->connections[index].socket_spare == socket_id) {
+            res = E_OK;
+            *id = index;
+            break;
+        }
+    }
+    return res;
+}
+
+static Std_ReturnType SoAd_SoGrp_Lookup(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType *id, TcpIp_SocketIdType socket_id)
+{
+    Std_ReturnType   res = E_NOT_OK;
+    SoAd_SoConIdType index;
+    for (index = 0u; index < SOAD_CFG_CONNECTIONGROUP_COUNT; ++index) {
+        if (SoAd_Instance->groups[index].socket_id == socket_id) {
+            res = E_OK;
+            *id = index;
+            break;
+        }
+    }
+    return res;
+}
+
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+static Std_ReturnType SoAd_AcceptFilter_Domain(TcpIp_DomainType domain, uint8* index, uint8* bits)
+{
+    Std_ReturnType res = E_OK;
+    switch (domain) {
+        case TCPIP_AF_INET:
+            *index = 0u;
+            *bits  = 32u;
+            break;
+        case TCPIP_AF_INET6:
+            *index = 1u;
+            *bits  = 128u;
+            break;
+        default:
+            res = E_NOT_OK;
+            break;
+    }
+    return res;
+}
+
+static uint8 SoAd_AcceptFilter_Bit(const uint32* addr, uint8 bit)
+{
+    return (uint8)((addr[bit >> 5u] >> (31u - (bit & 31u))) & 1u);
+}
+
+static Std_ReturnType SoAd_AcceptFilter_Node(SoAd_InstanceType* SoAd_Instance, uint16* node)
+{
+    Std_ReturnType res = E_NOT_OK;
+    if (SoAd_Instance->accept_trie.used < SOAD_CFG_ACCEPTFILTER_NODES) {
+        *node = SoAd_Instance->accept_trie.used++;
+        SoAd_Instance->accept_trie.nodes[*node].child[0] = SOAD_ACCEPT_INVALID;
+        SoAd_Instance->accept_trie.nodes[*node].child[1] = SOAD_ACCEPT_INVALID;
+        SoAd_Instance->accept_trie.nodes[*node].filter   = SOAD_ACCEPT_INVALID;
+        res = E_OK;
+    }
+    return res;
+}
+
+/**
+ * @brief Build the prefix trie from the configured filters
+ */
+static Std_ReturnType SoAd_Init_AcceptFilter(SoAd_InstanceType* SoAd_Instance)
+{
+    uint16 index;
+    uint16 node;
+    uint8  domain;
+    uint8  bits;
+    uint8  bit;
+
+    SoAd_Instance->accept_trie.used = 0u;
+    memset(SoAd_Instance->accept_trie.root, 0xff, sizeof(SoAd_Instance->accept_trie.root));
+
+    for (index = 0u; index < SOAD_CFG_ACCEPTFILTER_COUNT; ++index) {
+        const SoAd_AcceptFilterType* filter = SoAd_Instance->config->accept_filters[index];
+        uint16*                      link;
+
+        if (SoAd_AcceptFilter_Domain(filter->domain, &domain, &bits) != E_OK) {
+            return E_NOT_OK;
+        }
+
+        if ((filter->prefix > bits) || (filter->group >= SOAD_CFG_CONNECTIONGROUP_COUNT)) {
+            return E_NOT_OK;
+        }
+
+        link = &SoAd_Instance->accept_trie.root[filter->group][domain];
+        for (bit = 0u; ; ++bit) {
+            if (*link == SOAD_ACCEPT_INVALID) {
+                if (SoAd_AcceptFilter_Node(SoAd_Instance, link) != E_OK) {
+                    return E_NOT_OK;
+                }
+            }
+            node = *link;
+            if (bit == filter->prefix) {
+                break;
+            }
+            link = &SoAd_Instance->accept_trie.nodes[node].child[SoAd_AcceptFilter_Bit(filter->addr, bit)];
+        }
+
+        SoAd_Instance->accept_trie.next[index]        = SoAd_Instance->accept_trie.nodes[node].filter;
+        SoAd_Instance->accept_trie.nodes[node].filter = index;
+    }
+    return E_OK;
+}
+
+/**
+ * @brief Check remote against acceptance filters of group
+ *
+ * Walks one trie node per address bit, checking the port range of
+ * each filter whose prefix ends on the way.
+ */
+static boolean SoAd_AcceptFilter_Match(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, const TcpIp_SockAddrType* remote)
+{
+    const uint32* addr;
+    uint16        port;
+    uint16        node;
+    uint16        index;
+    uint8         domain;
+    uint8         bits;
+    uint8         bit;
+
+    if (SoAd_AcceptFilter_Domain(remote->domain, &domain, &bits) != E_OK) {
+        return FALSE;
+    }
+
+    if (domain == 0u) {
+        addr = ((const TcpIp_SockAddrInetType*)remote)->addr;
+        port = ((const TcpIp_SockAddrInetType*)remote)->port;
+    } else {
+        addr = ((const TcpIp_SockAddrInet6Type*)remote)->addr;
+        port = ((const TcpIp_SockAddrInet6Type*)remote)->port;
+    }
+
+    node = SoAd_Instance->accept_trie.root[id_grp][domain];
+    for (bit = 0u; node != SOAD_ACCEPT_INVALID; ++bit) {
+        for (index = SoAd_Instance->accept_trie.nodes[node].filter; index != SOAD_ACCEPT_INVALID; index = SoAd_Instance->accept_trie.next[index]) {
+            const SoAd_AcceptFilterType* filter = SoAd_Instance->config->accept_filters[index];
+            if ((port >= filter->port_min) && (port <= filter->port_max)) {
+                return TRUE;
+            }
+        }
+
+        if (bit == bits) {
+            break;
+        }
+        node = SoAd_Instance->accept_trie.nodes[node].child[SoAd_AcceptFilter_Bit(addr, bit)];
+    }
+    return FALSE;
+}
+#endif
+
+/**
+ * @brief Check if a remote not yet known may reach connections of a group
+ */
+static boolean SoAd_AcceptFilter_Check(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, const TcpIp_SockAddrType* remote)
+{
+    boolean res = TRUE;
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+    if (SoAd_Instance->config->groups[id_grp]->accept_filter == TRUE) {
+        res = SoAd_AcceptFilter_Match(SoAd_Instance, id_grp, remote);
+        if (res == FALSE) {
+            SOAD_MEAS_INC(rx_filtered, 1u);
+        }
+    }
+#endif
+    return res;
+}
+
+static boolean SoAd_SoCon_Unbound(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+    return ((status->socket_id == TCPIP_SOCKETID_INVALID)
+         && (status->state     != SOAD_SOCON_OFFLINE)) ? TRUE : FALSE;
+}
+
+static Std_ReturnType SoAd_SoCon_Lookup_FreeSocket(
+        SoAd_InstanceType*        SoAd_Instance,
+        SoAd_SoConIdType*         id,
+        SoAd_SoGrpIdType          group,
+        const TcpIp_SockAddrType* remote
+    )
+{
+    SoAd_RemoteIdType id_remote = SoAd_Remote_Lookup(SoAd_Instance, remote);
+    SoAd_SoConIdType  id_con;
+
+    /* exact remotes are found from the holders of the interned address */
+    if ((id_remote != SOAD_REMOTEID_INVALID) && (SoAd_Instance->remotes[id_remote].wildcard == FALSE)) {
+        for (id_con = SoAd_Instance->remotes[id_remote].holders; id_con != SOAD_SOCONID_INVALID; id_con = SoAd_Instance->connections[id_con].remote_next) {
+            if ((SoAd_Instance->config->connections[id_con]->group == group)
+            &&  (SoAd_SoCon_Unbound(SoAd_Instance, id_con) == TRUE)) {
+                *id = id_con;
+                return E_OK;
+            }
+        }
+    }
+
+    /* only wildcards need a field compare */
+    for (id_con = SoAd_Instance->groups[group].free; id_con != SOAD_SOCONID_INVALID; id_con = SoAd_Instance->connections[id_con].remote_next) {
+        if ((SoAd_SoCon_Unbound(SoAd_Instance, id_con) == TRUE)
+        &&  (SoAd_SockAddrWildcardMatch(SoAd_Remote_Address(SoAd_Instance, SoAd_Instance->connections[id_con].remote), remote) == TRUE)) {
+            *id = id_con;
+            return E_OK;
+        }
+    }
+    return E_NOT_OK;
+}
+
+static void SoAd_SoCon_EnterState(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, SoAd_SoConStateType);
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+static void SoAd_InFlight_Ack(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, uint32 length, uint16 records);
+#endif
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+static void SoAd_Trace_Record(
+        SoAd_InstanceType*  SoAd_Instance,
+        uint8               point,
+        uint32              timestamp,
+        SoAd_SoConIdType    con,
+        uint16              route,
+        uint16              length,
+        Std_ReturnType      result
+    )
+{
+    SoAd_TraceType*      trace = &SoAd_Instance->trace[SOAD_CFG_GET_CORE_ID()];
+    uint32               head  = trace->head;
+    SoAd_TraceEventType* event = &trace->events[head & (SOAD_CFG_TRACE_SIZE - 1u)];
+
+    /* the slot still holds event head - SOAD_CFG_TRACE_SIZE, retire it first */
+    trace->claim      = head + 1u;
+    SOAD_CFG_ATOMIC_FENCE_RELEASE();
+
+    event->timestamp  = timestamp;
+    event->point      = point;
+    event->result     = result;
+    event->connection = con;
+    event->route      = route;
+    event->length     = length;
+
+    SOAD_CFG_ATOMIC_FENCE_RELEASE();
+    trace->head       = head + 1u;
+}
+
+static uint32 SoAd_Trace_Enter(SoAd_InstanceType* SoAd_Instance, uint8 point)
+{
+    uint32 now = SOAD_CFG_TRACE_TIMESTAMP();
+    SoAd_Trace_Record(SoAd_Instance, point, now, SOAD_SOCONID_INVALID, SOAD_TRACE_ROUTE_NONE, 0u, E_OK);
+    return now;
+}
+
+static void SoAd_Trace_Exit(
+        SoAd_InstanceType*  SoAd_Instance,
+        uint8               point,
+        uint32              start,
+        SoAd_SoConIdType    con,
+        uint16              route,
+        uint16              length,
+        Std_ReturnType      result
+    )
+{
+    uint32 now   = SOAD_CFG_TRACE_TIMESTAMP();
+    uint32 delta = now - start;
+    uint8  bin   = 0u;
+
+    while (delta != 0u) {
+        ++bin;
+        delta >>= 1u;
+    }
+    /* the last bin also collects latencies of 2^31 and above */
+    if (bin > 31u) {
+        bin = 31u;
+    }
+    SoAd_Instance->trace[SOAD_CFG_GET_CORE_ID()].histograms[point].bins[bin]++;
+
+    SoAd_Trace_Record(SoAd_Instance, point | SOAD_TRACE_FLAG_EXIT, now, con, route, length, result);
+}
+#endif
+
+void SoAd_Init(const SoAd_ConfigType* config)
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    uint16  id;
+    boolean failed = FALSE;
+
+    SoAd_Instance->config               = config;
+    SoAd_Instance->tx_copy              = SOAD_SOCONID_INVALID;
+    SoAd_Instance->if_gather.connection = SOAD_SOCONID_INVALID;
+
+    SoAd_Init_Timer(SoAd_Instance);
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    memset(SoAd_Instance->measurement, 0, sizeof(SoAd_Instance->measurement));
+#endif
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+    memset(SoAd_Instance->trace, 0, sizeof(SoAd_Instance->trace));
+#endif
+
+    SoAd_Instance->mainfunction_cursor = 0u;
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    memset(&SoAd_Instance->mainfunction_timing, 0, sizeof(SoAd_Instance->mainfunction_timing));
+#endif
+
+    memset(SoAd_Instance->remotes, 0, sizeof(SoAd_Instance->remotes));
+    memset(SoAd_Instance->remote_store, 0, sizeof(SoAd_Instance->remote_store));
+    SoAd_Instance->remote_tombstones = 0u;
+
+    if (SoAd_Init_SoGrpMembers(SoAd_Instance) != E_OK) {
+        failed = TRUE;
+    }
+
+    /* groups first, connections link into their free lists */
+    for (id = 0u; id < SOAD_CFG_CONNECTIONGROUP_COUNT; ++id) {
+        if (SoAd_Init_SoGrp(SoAd_Instance, (SoAd_SoGrpIdType)id) != E_OK) {
+            failed = TRUE;
+        }
+    }
+
+    /** @req SWS_SoAd_00723 */
+    /* in reverse, so remote lists start out in ascending id order */
+    for (id = SOAD_CFG_CONNECTION_COUNT; id > 0u; --id) {
+        if (SoAd_Init_SoCon(SoAd_Instance, (SoAd_SoConIdType)(id - 1u)) != E_OK) {
+            failed = TRUE;
+        }
+    }
+
+    SoAd_SoConList_Init(&SoAd_Instance->rx_window);
+    SoAd_SoConList_Init(&SoAd_Instance->requests);
+    memset(&SoAd_Instance->tx_schedule, 0, sizeof(SoAd_Instance->tx_schedule));
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+    memset(SoAd_Instance->inflight, 0, sizeof(SoAd_Instance->inflight));
+    SoAd_SoConList_Init(&SoAd_Instance->inflight_list);
+#else
+    memset(SoAd_Instance->if_confirm_due, 0, sizeof(SoAd_Instance->if_confirm_due));
+    SoAd_Instance->if_confirm_head  = 0u;
+    SoAd_Instance->if_confirm_count = 0u;
+#endif
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+    SoAd_SoConList_Init(&SoAd_Instance->modechg_list);
+#endif
+
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 0u)
+    for (id = 0u; id < SOAD_CFG_CONNECTION_COUNT; ++id) {
+        SOAD_CFG_ATOMIC_STORE(&SoAd_Instance->routing[id], config->routing_init);
+    }
+#endif
+
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+    memset(SoAd_Instance->rate_limit, 0, sizeof(SoAd_Instance->rate_limit));
+#endif
+
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+    for (id = 0u; id < SOAD_CFG_LOCALADDR_COUNT; ++id) {
+        SoAd_Instance->localaddrs[id].state   = TCPIP_IPADDR_STATE_UNASSIGNED;
+        SoAd_Instance->localaddrs[id].waiting = SOAD_SOCONID_INVALID;
+    }
+#endif
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    if (SoAd_Init_Buffer(SoAd_Instance) != E_OK) {
+        failed = TRUE;
+    }
+
+    for (id = 0u; id < SOAD_CFG_PDUROUTE_COUNT; ++id) {
+        SoAd_Instance->if_held[id].buffer = SOAD_BUFFERID_INVALID;
+        SoAd_Instance->if_held[id].next   = SOAD_PDUID_INVALID;
+    }
+#endif
+
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+    if (SoAd_Init_AcceptFilter(SoAd_Instance) != E_OK) {
+        failed = TRUE;
+    }
+#endif
+
+    if (failed) {
+        SOAD_DET_ERROR(SOAD_API_INIT
+                     , SOAD_E_INIT_FAILED);
+        SoAd_Instance->config = NULL_PTR;
+    }
+}
+
+/**
+ * @brief Bytes of memory needed for an instance with the given configuration
+ *
+ * All tables are sized by SoAd_Cfg.h, so every configuration built
+ * against it needs the same size.
+ */
+uint32 SoAd_GetInstanceSize(const SoAd_ConfigType* config)
+{
+    (void)config;
+    return (uint32)sizeof(SoAd_InstanceType);
+}
+
+/**
+ * @brief Set up an instance in memory of SoAd_GetInstanceSize bytes
+ *
+ * The memory must be aligned for any type, as returned by malloc. The
+ * instance selected for the calling context is left unchanged.
+ */
+SoAd_InstanceType* SoAd_InitInstance(
+        void*                       memory,
+        uint8                       instance_id,
+        const SoAd_ConfigType*      config
+    )
+{
+#if(SOAD_CFG_ENABLE_DEVELOPMENT_ERROR == STD_ON)
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+#endif
+    SoAd_InstanceType*       instance      = (SoAd_InstanceType*)memory;
+    SoAd_InstanceType*       previous;
+
+    if (memory == NULL_PTR) {
+        SOAD_DET_ERROR(SOAD_API_INIT, SOAD_E_PARAM_POINTER);
+        return NULL_PTR;
+    }
+
+    memset(instance, 0, sizeof(*instance));
+    instance->instance_id = instance_id;
+
+    previous = SoAd_SetInstance(instance);
+    SoAd_Init(config);
+    (void)SoAd_SetInstance(previous);
+    return instance;
+}
+
+/**
+ * @brief Select the instance the calling context works on
+ *
+ * All other APIs, including callbacks from TcpIp, act on the selected
+ * instance. NULL_PTR selects the default instance of SoAd_Init. The
+ * selection is kept per core, see SOAD_CFG_INSTANCE_CORE_COUNT.
+ *
+ * @return instance selected before
+ */
+SoAd_InstanceType* SoAd_SetInstance(SoAd_InstanceType* instance)
+{
+    SoAd_InstanceType* previous = SoAd_Instance_Get();
+
+    SOAD_INSTANCE_SELECTED = instance;
+    return previous;
+}
+
+/**
+ * @brief Run the main function of an instance, whatever the core has selected
+ *
+ * The selection is restored before returning, so a call preempting
+ * another API of the same core leaves that one on its instance.
+ */
+void SoAd_MainFunctionInstance(SoAd_InstanceType* instance)
+{
+    SoAd_InstanceType* previous = SoAd_SetInstance(instance);
+
+    SoAd_MainFunction();
+    (void)SoAd_SetInstance(previous);
+}
+
+/**
+ * @brief SoAd_IfTransmit on an instance, see SoAd_MainFunctionInstance
+ */
+Std_ReturnType SoAd_IfTransmitInstance(
+        SoAd_InstanceType*          instance,
+        PduIdType                   pdu_id,
+        const PduInfoType*          pdu_info
+    )
+{
+    SoAd_InstanceType* previous = SoAd_SetInstance(instance);
+    Std_ReturnType     res;
+
+    res = SoAd_IfTransmit(pdu_id, pdu_info);
+    (void)SoAd_SetInstance(previous);
+    return res;
+}
+
+/**
+ * @brief SoAd_TpTransmit on an instance, see SoAd_MainFunctionInstance
+ */
+Std_ReturnType SoAd_TpTransmitInstance(
+        SoAd_InstanceType*          instance,
+        PduIdType                   pdu_id,
+        const PduInfoType*          pdu_info
+    )
+{
+    SoAd_InstanceType* previous = SoAd_SetInstance(instance);
+    Std_ReturnType     res;
+
+    res = SoAd_TpTransmit(pdu_id, pdu_info);
+    (void)SoAd_SetInstance(previous);
+    return res;
+}
+
+static Std_ReturnType SoAd_GetSocketRoute(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, uint32 header_id, SoAd_SocketRouteIdType* route_id)
+{
+    Std_ReturnType              res;
+    const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[con_id];
+    const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+
+    /* TODO - there can be multiple routes mapped to each connection */
+    if (con_config->socket_route_id != SOAD_SOCKETROUTEID_INVALID) {
+        *route_id = con_config->socket_route_id;
+        res = E_OK;
+    } else if (grp_config->socket_route_id < SOAD_SOCKETROUTEID_INVALID) {
+        *route_id = grp_config->socket_route_id;
+        res = E_OK;
+    } else {
+        res = E_NOT_OK;
+    }
+    return res;
+}
+
+/**
+ * @brief Write a PDU header, id and length in network byte order
+ */
+static void SoAd_PduHeader_Write(uint8* header, uint32 header_id, uint32 length)
+{
+    header[0] = (uint8)(header_id >> 24u);
+    header[1] = (uint8)(header_id >> 16u);
+    header[2] = (uint8)(header_id >>  8u);
+    header[3] = (uint8)(header_id       );
+    header[4] = (uint8)(length    >> 24u);
+    header[5] = (uint8)(length    >> 16u);
+    header[6] = (uint8)(length    >>  8u);
+    header[7] = (uint8)(length          );
+}
+
+static Std_ReturnType SoAd_GetPduRoute(SoAd_InstanceType* SoAd_Instance, PduIdType id, const SoAd_PduRouteType** route)
+{
+    Std_ReturnType res;
+    PduIdType      high = SOAD_CFG_PDUROUTE_COUNT - 1u;
+    PduIdType      low  = 0u;
+
+    while (low < high) {
+        PduIdType mid = low + (PduIdType)((high - low) >> 1u);
+        if (SoAd_Instance->config->pdu_routes[mid]->pdu_id < id) {
             low = mid + 1u;
         } else {
-            low = mid;
+            high = mid;
+        }
+    }
+
+    if (SoAd_Instance->config->pdu_routes[low]->pdu_id == id) {
+        *route = SoAd_Instance->config->pdu_routes[low];
+        res = E_OK;
+    } else {
+        res = E_NOT_OK;
+    }
+    return res;
+}
+
+/**
+ * @brief Performs check to see if socket should go online
+ * @req   SWS_SoAd_00592
+ */
+static void SoAd_RxIndication_RemoteOnline(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, const TcpIp_SockAddrType* remote, SoAd_RemoteIdType* restore, SoAd_SoConStateType* state)
+{
+    SoAd_SoConStatusType*       con_status = &SoAd_Instance->connections[con_id];
+
+    *state = con_status->state;
+    if (con_status->state != SOAD_SOCON_ONLINE) {
+        const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[con_id];
+        const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+        if (grp_config->protocol == TCPIP_IPPROTO_UDP) {
+            if (grp_config->listen_only == FALSE) {
+                SoAd_RemoteIdType id_remote;
+                if ((SoAd_Remote_Wildcard(SoAd_Instance, con_status->remote) == TRUE)
+                &&  (SoAd_Remote_Acquire(SoAd_Instance, remote, &id_remote) == E_OK)) {
+                    /* (4) acceptance filter was checked by SoAd_RxIndication_Admit */
+                    /* TODO - (6) Acceptance policy */
+
+                    /* reference on the old remote moves to restore */
+                    *restore = con_status->remote;
+                    SoAd_Remote_Retain(SoAd_Instance, *restore);
+                    SoAd_SoCon_SetRemote(SoAd_Instance, con_id, id_remote);
+                    SoAd_SoCon_EnterState(SoAd_Instance, con_id, SOAD_SOCON_ONLINE);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Revert remote address change if state mismatches
+ * @req SWS_SoAd_00710
+ */
+static void SoAd_RxIndication_RemoteRevert(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, SoAd_RemoteIdType remote, const SoAd_SoConStateType state)
+{
+    SoAd_SoConStatusType* con_status = &SoAd_Instance->connections[con_id];
+
+    if ((con_status->state != state) && (remote != SOAD_REMOTEID_INVALID)) {
+        SoAd_SoCon_SetRemote(SoAd_Instance, con_id, remote);
+        SoAd_SoCon_EnterState(SoAd_Instance, con_id, state);
+    } else {
+        SoAd_Remote_Release(SoAd_Instance, remote);
+    }
+}
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+/**
+ * @brief Forward buffered receive data to upper layer as far as it has space
+ */
+static Std_ReturnType SoAd_SoCon_ProcessReceive(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    SoAd_SoConStatusType*  con_sts = &SoAd_Instance->connections[con_id];
+    SoAd_BufferStatusType* buffer;
+    PduInfoType            info;
+    PduLengthType          buf_len;
+    uint8*                 data;
+
+    if ((con_sts->rx_buffer == SOAD_BUFFERID_INVALID) || (con_sts->rx_route == NULL_PTR)) {
+        return E_OK;
+    }
+
+    buffer = &SoAd_Instance->buffer_pool.buffers[con_sts->rx_buffer];
+    data   = SoAd_Buffer_Data(SoAd_Instance, con_sts->rx_buffer);
+
+    info.SduDataPtr = NULL_PTR;
+    info.SduLength  = 0u;
+
+    if (con_sts->rx_route->destination.upper->copy_rx_data(
+            con_sts->rx_route->destination.pdu
+          , &info
+          , &buf_len) != BUFREQ_OK) {
+        return E_NOT_OK;
+    }
+
+    if (buf_len > buffer->length) {
+        buf_len = buffer->length;
+    }
+
+    if (buf_len > 0u) {
+        info.SduDataPtr = data;
+        info.SduLength  = buf_len;
+
+        if (con_sts->rx_route->destination.upper->copy_rx_data(
+                con_sts->rx_route->destination.pdu
+              , &info
+              , &buf_len) != BUFREQ_OK) {
+            return E_NOT_OK;
+        }
+
+        buffer->length -= info.SduLength;
+        memmove(data, data + info.SduLength, buffer->length);
+    }
+
+    if (buffer->length == 0u) {
+        SoAd_Buffer_Free(SoAd_Instance, con_sts->rx_buffer);
+        con_sts->rx_buffer = SOAD_BUFFERID_INVALID;
+    }
+    return E_OK;
+}
+#endif
+
+Std_ReturnType SoAd_RxIndication_SoCon(
+        SoAd_InstanceType*          SoAd_Instance,
+        SoAd_SoConIdType            con_id,
+        uint8*                      buf,
+        uint16                      len
+    )
+{
+    PduInfoType                 info;
+    SoAd_SoConStatusType*       con_sts = &SoAd_Instance->connections[con_id];
+
+    /* TODO - header id handling */
+
+
+    if ((con_sts->rx_route != NULL_PTR)
+    &&  SOAD_ROUTING_ENABLED(con_sts->rx_route->routing_groups, con_id)) {
+        PduLengthType     buf_len;
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+        /* data must be delivered in order behind already buffered data */
+        if (con_sts->rx_buffer != SOAD_BUFFERID_INVALID) {
+            if (SoAd_Buffer_Append(SoAd_Instance, con_id, &con_sts->rx_buffer, buf, len) != E_OK) {
+                return E_NOT_OK;
+            }
+            return SoAd_SoCon_ProcessReceive(SoAd_Instance, con_id);
+        }
+#endif
+
+        info.SduDataPtr = NULL_PTR;
+        info.SduLength  = 0u;
+
+        if (con_sts->rx_route->destination.upper->copy_rx_data(
+                con_sts->rx_route->destination.pdu
+              , &info
+              , &buf_len) != BUFREQ_OK) {
+            return E_NOT_OK;
+        }
+
+        if (buf_len < len) {
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+            const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[con_id];
+            const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+
+            /* a stream can be split, so keep what upper layer can't take yet */
+            if (grp_config->protocol == TCPIP_IPPROTO_TCP) {
+                if (SoAd_Buffer_Append(SoAd_Instance, con_id, &con_sts->rx_buffer, buf + buf_len, len - buf_len) != E_OK) {
+                    return E_NOT_OK;
+                }
+                len = buf_len;
+            } else {
+                return E_NOT_OK;
+            }
+#else
+            return E_NOT_OK;
+#endif
+        }
+
+        if (len > 0u) {
+            info.SduLength = len;
+            info.SduDataPtr = buf;
+
+            if (con_sts->rx_route->destination.upper->copy_rx_data(
+                    con_sts->rx_route->destination.pdu
+                  , &info
+                  , &buf_len) != BUFREQ_OK) {
+                return E_NOT_OK;
+            }
+        }
+    } else {
+        SOAD_MEAS_INC(connections[con_id].rx_drop_route, 1u);
+    }
+
+    return E_OK;
+}
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+static void SoAd_Measure_Rx(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id_con, uint16 len, Std_ReturnType res)
+{
+    SoAd_MeasurementDataType* meas = &SoAd_Instance->measurement[SOAD_CFG_GET_CORE_ID()];
+    SoAd_SocketRouteIdType    route_id;
+    boolean                   routed;
+
+    routed = (SoAd_GetSocketRoute(SoAd_Instance, id_con, SOAD_PDUHEADERID_INVALID, &route_id) == E_OK);
+    if (res == E_OK) {
+        meas->connections[id_con].rx_pdus++;
+        meas->connections[id_con].rx_bytes += len;
+        if (routed) {
+            meas->socket_routes[route_id].rx_pdus++;
+            meas->socket_routes[route_id].rx_bytes += len;
+        }
+    } else {
+        meas->connections[id_con].rx_drop_buffer++;
+        if (routed) {
+            meas->socket_routes[route_id].rx_dropped++;
+        }
+    }
+}
+
+static void SoAd_Measure_Tx(SoAd_InstanceType* SoAd_Instance, PduIdType pdu_id, SoAd_SoConIdType id_con, PduLengthType len, Std_ReturnType res)
+{
+    SoAd_MeasurementDataType* meas = &SoAd_Instance->measurement[SOAD_CFG_GET_CORE_ID()];
+
+    if (res == E_OK) {
+        meas->connections[id_con].tx_pdus++;
+        meas->connections[id_con].tx_bytes += len;
+        meas->pdu_routes[pdu_id].tx_pdus++;
+        meas->pdu_routes[pdu_id].tx_bytes += len;
+    } else {
+        if (SoAd_Instance->connections[id_con].state == SOAD_SOCON_ONLINE) {
+            meas->connections[id_con].tx_drop_tcpip++;
+        } else {
+            meas->connections[id_con].tx_drop_offline++;
+        }
+        meas->pdu_routes[pdu_id].tx_dropped++;
+    }
+}
+#endif
+
+/**
+ * @brief Restart alive supervision of a connection with a remote learned from a wildcard
+ * @req   SWS_SoAd_00695
+ */
+static void SoAd_RxIndication_AliveSupervision(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id)
+{
+    const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[con_id];
+    const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+
+    if ((grp_config->protocol == TCPIP_IPPROTO_UDP)
+    &&  (grp_config->udp_alive_timeout != 0u)
+    &&  (SoAd_Instance->connections[con_id].state == SOAD_SOCON_ONLINE)
+    &&  (con_config->remote != NULL_PTR)) {
+        if (SoAd_SockAddrWildcard(con_config->remote) == TRUE) {
+            SoAd_Timer_Arm(SoAd_Instance, SOAD_TIMER_ID(con_id, SOAD_TIMER_ALIVE), grp_config->udp_alive_timeout);
+        }
+    }
+}
+
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+static SoAd_RateLimitEntryType* SoAd_RateLimit_Find(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, const TcpIp_SockAddrType* remote)
+{
+    uint32                   key[4] = { 0u, 0u, 0u, 0u };
+    uint32                   hash   = 2166136261u;
+    uint32                   now    = SoAd_Instance->timer_wheel.now;
+    SoAd_RateLimitEntryType* victim = NULL_PTR;
+    SoAd_RateLimitEntryType* entry;
+    uint8                    index;
+
+    switch (remote->domain) {
+        case TCPIP_AF_INET:
+            key[0] = ((const TcpIp_SockAddrInetType*)remote)->addr[0];
+            break;
+        case TCPIP_AF_INET6:
+            memcpy(key, ((const TcpIp_SockAddrInet6Type*)remote)->addr, sizeof(key));
+            break;
+        default:
+            return NULL_PTR;
+    }
+
+    /* fnv-1a over whole words */
+    for (index = 0u; index < 4u; ++index) {
+        hash = (hash ^ key[index]) * 16777619u;
+    }
+    hash = (hash ^ id_grp) * 16777619u;
+
+    for (index = 0u; index < SOAD_RATELIMIT_PROBES; ++index) {
+        entry = &SoAd_Instance->rate_limit[(hash + index) & (SOAD_CFG_RATELIMIT_COUNT - 1u)];
+        if ((entry->domain == remote->domain)
+        &&  (entry->group  == id_grp)
+        &&  (SoAd_Ip6Equal(entry->addr, key) == TRUE)) {
+            return entry;
+        }
+
+        /* replace a free slot, else the one idle the longest */
+        if (victim == NULL_PTR) {
+            victim = entry;
+        } else if ((victim->domain != 0u)
+               && ((entry->domain  == 0u) || ((now - entry->seen) > (now - victim->seen)))) {
+            victim = entry;
+        }
+    }
+
+    memcpy(victim->addr, key, sizeof(key));
+    victim->domain = remote->domain;
+    victim->group  = id_grp;
+    victim->tokens = SoAd_Instance->config->groups[id_grp]->rx_limit.burst;
+    victim->refill = now;
+    return victim;
+}
+
+/**
+ * @brief Check if a datagram from remote fits the rate limit of its group
+ *
+ * Runs before connection matching, so a flooding peer costs a hash
+ * lookup per datagram instead of a full reception.
+ */
+static boolean SoAd_RateLimit_Accept(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, const TcpIp_SockAddrType* remote)
+{
+    const SoAd_RateLimitConfigType* config = &SoAd_Instance->config->groups[id_grp]->rx_limit;
+    SoAd_RateLimitEntryType*        entry;
+    uint32                          now = SoAd_Instance->timer_wheel.now;
+    uint32                          periods;
+    uint32                          room;
+
+    if (config->rate == 0u) {
+        return TRUE;
+    }
+
+    entry = SoAd_RateLimit_Find(SoAd_Instance, id_grp, remote);
+    if (entry == NULL_PTR) {
+        return TRUE;
+    }
+    entry->seen = now;
+
+    if ((now - entry->refill) >= config->period) {
+        periods        = (now - entry->refill) / config->period;
+        room           = config->burst - (uint32)entry->tokens;
+        if (periods > (room / config->rate)) {
+            entry->tokens = (uint16)config->burst;
+        } else {
+            entry->tokens = (uint16)(entry->tokens + (periods * config->rate));
+        }
+        entry->refill += periods * config->period;
+    }
+
+    if (entry->tokens == 0u) {
+        return FALSE;
+    }
+    entry->tokens--;
+    return TRUE;
+}
+#endif
+
+/**
+ * @brief Early drop of datagrams on a group socket, before connection matching
+ */
+static boolean SoAd_RxIndication_Admit(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp, const TcpIp_SockAddrType* remote)
+{
+    if (SoAd_AcceptFilter_Check(SoAd_Instance, id_grp, remote) == FALSE) {
+        return FALSE;
+    }
+
+#if(SOAD_CFG_RATELIMIT_COUNT > 0u)
+    if (SoAd_RateLimit_Accept(SoAd_Instance, id_grp, remote) == FALSE) {
+        SOAD_MEAS_INC(rx_rate_limited, 1u);
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+/**
+ * @brief Report consumed TCP receive data to reopen the receive window
+ *
+ * @req SWS_SoAd_00564
+ *
+ * Updates are batched until the group threshold is reached, or
+ * else sent once from the main function, to save window update ACKs.
+ */
+static void SoAd_SoCon_RxConsumed(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType con_id, uint32 len)
+{
+    const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[con_id];
+    const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+    SoAd_SoConStatusType*       con_status = &SoAd_Instance->connections[con_id];
+
+    con_status->rx_unacked += len;
+    if ((grp_config->rx_window_threshold != 0u)
+    &&  (con_status->rx_unacked >= grp_config->rx_window_threshold)) {
+        (void)TcpIp_TcpReceived(con_status->socket_id, con_status->rx_unacked);
+        con_status->rx_unacked = 0u;
+    } else {
+        SoAd_SoConList_Push(&SoAd_Instance->rx_window, con_id);
+    }
+}
+
+static void SoAd_RxWindow_MainFunction(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_SoConIdType      id;
+    SoAd_SoConStatusType* status;
+
+    while (SoAd_SoConList_Pop(&SoAd_Instance->rx_window, &id)) {
+        status = &SoAd_Instance->connections[id];
+        if ((status->rx_unacked != 0u) && (status->socket_id != TCPIP_SOCKETID_INVALID)) {
+            (void)TcpIp_TcpReceived(status->socket_id, status->rx_unacked);
+        }
+        status->rx_unacked = 0u;
+    }
+}
+
+void SoAd_RxIndication(
+        TcpIp_SocketIdType          socket_id,
+        const TcpIp_SockAddrType*   remote,
+        uint8*                      buf,
+        uint16                      len
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id_con;
+    Std_ReturnType   res;
+
+    /**
+     * @req SWS_SoAd_00264
+     */
+    SOAD_DET_CHECK_RET_0(SoAd_Instance->config != NULL_PTR
+                       , SOAD_API_RXINDICATION
+                       , SOAD_E_NOTINIT);
+
+    /**
+     * @req SWS_SoAd_00264
+     */
+    SOAD_DET_CHECK_RET_0(remote != NULL_PTR
+                       , SOAD_API_RXINDICATION
+                       , SOAD_E_INV_ARG);
+
+    SOAD_TRACE_ENTER(SOAD_TRACE_RXINDICATION);
+
+    res = SoAd_SoCon_Lookup(SoAd_Instance, &id_con, socket_id);
+    if ((res != E_OK) && (socket_id != TCPIP_SOCKETID_INVALID)
+    &&  (SoAd_SoCon_LookupSpare(SoAd_Instance, &id_con, socket_id) == E_OK)) {
+        /* a parked udp socket stays bound, but its connection is closed */
+        SOAD_MEAS_INC(drop_udp, 1u);
+        SOAD_TRACE_EXIT(SOAD_TRACE_RXINDICATION, id_con, SOAD_TRACE_ROUTE_NONE, len, E_NOT_OK);
+        return;
+    }
+
+    if (res != E_OK) {
+        SoAd_SoGrpIdType id_grp;
+        res = SoAd_SoGrp_Lookup(SoAd_Instance, &id_grp, socket_id);
+        if (res == E_OK) {
+            if (SoAd_RxIndication_Admit(SoAd_Instance, id_grp, remote) == FALSE) {
+                SOAD_TRACE_EXIT(SOAD_TRACE_RXINDICATION, SOAD_SOCONID_INVALID, SOAD_TRACE_ROUTE_NONE, len, E_NOT_OK);
+                return;
+            }
+            res = SoAd_SoCon_Lookup_FreeSocket(SoAd_Instance, &id_con, id_grp, remote);
+            if (res != E_OK) {
+                if (SoAd_Instance->config->groups[id_grp]->protocol == TCPIP_IPPROTO_TCP) {
+                    SOAD_MEAS_INC(drop_tcp, 1u);
+                } else {
+                    SOAD_MEAS_INC(drop_udp, 1u);
+                }
+            }
+        } else {
+            SOAD_MEAS_INC(lookup_miss, 1u);
+        }
+    }
+
+    if (res == E_OK) {
+        SoAd_RemoteIdType           revert_remote = SOAD_REMOTEID_INVALID;
+        SoAd_SoConStateType         revert_state;
+        SoAd_RxIndication_RemoteOnline(SoAd_Instance, id_con, remote, &revert_remote, &revert_state);
+
+        res = SoAd_RxIndication_SoCon(SoAd_Instance, id_con, buf, len);
+
+        if (res != E_OK) {
+            SoAd_RxIndication_RemoteRevert(SoAd_Instance, id_con, revert_remote, revert_state);
+        } else {
+            SoAd_Remote_Release(SoAd_Instance, revert_remote);
+            SoAd_RxIndication_AliveSupervision(SoAd_Instance, id_con);
+        }
+
+        /* data is now with upper layer, in our buffer or dropped, either way TcpIp is done with it */
+        if (SoAd_Instance->config->groups[SoAd_Instance->config->connections[id_con]->group]->protocol == TCPIP_IPPROTO_TCP) {
+            SoAd_SoCon_RxConsumed(SoAd_Instance, id_con, len);
+        }
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+        SoAd_Measure_Rx(SoAd_Instance, id_con, len, res);
+#endif
+    } else {
+        /**
+         * @req SWS_SoAd_00267
+         */
+        SOAD_DET_ERROR(SOAD_API_RXINDICATION
+                     , SOAD_E_INV_SOCKETID);
+        id_con = SOAD_SOCONID_INVALID;
+    }
+
+    SOAD_TRACE_EXIT(SOAD_TRACE_RXINDICATION, id_con, SOAD_TRACE_ROUTE_NONE, len, res);
+}
+
+/**
+ * @brief Close down a socket group
+ *
+ * @req SWS_SoAd_00646
+ * @req SWS_SoAd_00643
+ *
+ * Specification is unclear on how to handle sockets
+ * that are in RECONNECT state, ie for example all
+ * child sockets of a listening group socket. This
+ * implementation will close down all group sockets
+ * if the "master" socket is lost.
+ */
+static void SoAd_SoGrp_Close(SoAd_InstanceType* SoAd_Instance, SoAd_SoGrpIdType id_grp)
+{
+    SoAd_SoGrpStatusType* status_grp = &SoAd_Instance->groups[id_grp];
+    SoAd_SoConIdType      index;
+
+    SOAD_CFG_ATOMIC_STORE(&status_grp->socket_id, TCPIP_SOCKETID_INVALID);
+
+    for (index = SoAd_Instance->members.first[id_grp]; index < SoAd_Instance->members.first[id_grp + 1u]; ++index) {
+        SoAd_SoConIdType            id_con = SoAd_Instance->members.members[index];
+        const SoAd_SoConStatusType* status = &SoAd_Instance->connections[id_con];
+        if (status->socket_id == TCPIP_SOCKETID_INVALID) {
+            SoAd_SoCon_EnterState(SoAd_Instance, id_con, SOAD_SOCON_OFFLINE);
+        }
+    }
+}
+
+void SoAd_TcpIpEvent(
+        TcpIp_SocketIdType          socket_id,
+        TcpIp_EventType             event
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id_con;
+    SoAd_SoGrpIdType id_grp;
+    Std_ReturnType   res;
+
+    /**
+     * @req SWS_SoAd_00276
+     */
+    SOAD_DET_CHECK_RET_0(SoAd_Instance->config != NULL_PTR
+                       , SOAD_API_TCPIPEVENT
+                       , SOAD_E_NOTINIT);
+
+
+    switch (event) {
+        case TCPIP_TCP_FIN_RECEIVED:
+            (void)TcpIp_Close(socket_id, FALSE);
+            break;
+
+        case TCPIP_TCP_RESET:
+        case TCPIP_TCP_CLOSED:
+        case TCPIP_UDP_CLOSED:
+            res = SoAd_SoGrp_Lookup(SoAd_Instance, &id_grp, socket_id);
+            if (res == E_OK) {
+                SoAd_SoGrp_Close(SoAd_Instance, id_grp);
+            } else {
+                res = SoAd_SoCon_Lookup(SoAd_Instance, &id_con, socket_id);
+                if (res == E_OK) {
+                    SoAd_SoCon_EnterState(SoAd_Instance, id_con, SOAD_SOCON_OFFLINE);
+                } else if (SoAd_SoCon_LookupSpare(SoAd_Instance, &id_con, socket_id) == E_OK) {
+                    /* spare is gone, the next open takes a new socket */
+                    SoAd_Instance->connections[id_con].socket_spare = TCPIP_SOCKETID_INVALID;
+                } else {
+                    /**
+                     * @req SWS_SoAd_00277
+                     */
+                    SOAD_DET_ERROR(SOAD_API_TCPIPEVENT
+                                 , SOAD_E_INV_SOCKETID);
+                }
+            }
+            break;
+        default:
+            SOAD_DET_ERROR(SOAD_API_TCPIPEVENT
+                         , SOAD_E_INV_ARG);
+            break;
+    }
+
+}
+
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+/**
+ * @brief Close all sockets bound to a local address that was lost
+ *
+ * Socket ids are kept until TcpIp reports them closed, like any other
+ * close, so late events and indications still find their connection.
+ */
+static void SoAd_LocalAddr_Close(SoAd_InstanceType* SoAd_Instance, TcpIp_LocalAddrIdType id)
+{
+    SoAd_SoConIdType index;
+    SoAd_SoGrpIdType id_grp;
+
+    for (id_grp = 0u; id_grp < SOAD_CFG_CONNECTIONGROUP_COUNT; ++id_grp) {
+        SoAd_SoGrpStatusType* status_grp = &SoAd_Instance->groups[id_grp];
+
+        if (SoAd_Instance->config->groups[id_grp]->localaddr != id) {
+            continue;
+        }
+
+        for (index = SoAd_Instance->members.first[id_grp]; index < SoAd_Instance->members.first[id_grp + 1u]; ++index) {
+            SoAd_SoConIdType      id_con = SoAd_Instance->members.members[index];
+            SoAd_SoConStatusType* status = &SoAd_Instance->connections[id_con];
+
+            if (status->socket_id != TCPIP_SOCKETID_INVALID) {
+                (void)TcpIp_Close(status->socket_id, TRUE);
+            } else if ((status_grp->socket_id == TCPIP_SOCKETID_INVALID)
+                   &&  (status->state != SOAD_SOCON_OFFLINE)) {
+                /* no socket left to report the close */
+                SoAd_SoCon_EnterState(SoAd_Instance, id_con, SOAD_SOCON_OFFLINE);
+            } else {
+                /* goes offline with the group socket */
+            }
+            if (status->socket_spare != TCPIP_SOCKETID_INVALID) {
+                (void)TcpIp_Close(status->socket_spare, TRUE);
+            }
+        }
+
+        if (status_grp->socket_id != TCPIP_SOCKETID_INVALID) {
+            (void)TcpIp_Close(status_grp->socket_id, TRUE);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Track local address assignment
+ *
+ * Connections that tried to open while their local address was
+ * missing are queued on that address, and released in one go once
+ * it gets assigned. Losing the address closes all sockets bound to it.
+ */
+void SoAd_LocalIpAddrAssignmentChg(
+        TcpIp_LocalAddrIdType       id,
+        TcpIp_IpAddrStateType       state
+    )
+{
+#if(SOAD_CFG_ENABLE_DEVELOPMENT_ERROR == STD_ON) || (SOAD_CFG_LOCALADDR_COUNT > 0u)
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+#endif
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+    SoAd_LocalAddrStatusType* status;
+#endif
+
+    SOAD_DET_CHECK_RET_0(SoAd_Instance->config != NULL_PTR
+                       , SOAD_API_LOCALIPADDRASSIGNMENTCHG
+                       , SOAD_E_NOTINIT);
+
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+    SOAD_DET_CHECK_RET_0(id < SOAD_CFG_LOCALADDR_COUNT
+                       , SOAD_API_LOCALIPADDRASSIGNMENTCHG
+                       , SOAD_E_INV_ARG);
+
+    status = &SoAd_Instance->localaddrs[id];
+    status->state = state;
+
+    switch (state) {
+        case TCPIP_IPADDR_STATE_ASSIGNED:
+            while (status->waiting != SOAD_SOCONID_INVALID) {
+                SoAd_SoConStatusType* con_status = &SoAd_Instance->connections[status->waiting];
+                status->waiting          = con_status->addr_next;
+                con_status->addr_next    = SOAD_SOCONID_INVALID;
+                con_status->addr_waiting = FALSE;
+            }
+            break;
+
+        case TCPIP_IPADDR_STATE_UNASSIGNED:
+            SoAd_LocalAddr_Close(SoAd_Instance, id);
+            break;
+
+        default:
+            break;
+    }
+#endif
+}
+
+void SoAd_TxConfirmation(
+        TcpIp_SocketIdType          socket_id,
+        uint16                      len
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id;
+    Std_ReturnType   res;
+
+    res = SoAd_SoCon_Lookup(SoAd_Instance, &id, socket_id);
+    if (res == E_OK) {
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+        SoAd_InFlight_Ack(SoAd_Instance, id, len, SOAD_CFG_TX_INFLIGHT_SIZE);
+#endif
+    }
+}
+
+Std_ReturnType SoAd_TcpAccepted(
+        TcpIp_SocketIdType          socket_id,
+        TcpIp_SocketIdType          socket_id_connected,
+        const TcpIp_SockAddrType*   remote
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoGrpIdType id_group;
+    Std_ReturnType   res;
+
+    res = SoAd_SoGrp_Lookup(SoAd_Instance, &id_group, socket_id);
+    if (res == E_OK) {
+        const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[id_group];
+        SoAd_SoConIdType            id_connected;
+
+        if (group->initiate == FALSE) {
+            SoAd_RemoteIdType id_remote;
+
+            if (SoAd_AcceptFilter_Check(SoAd_Instance, id_group, remote) == TRUE) {
+                res = SoAd_SoCon_Lookup_FreeSocket(SoAd_Instance, &id_connected, id_group, remote);
+            } else {
+                res = E_NOT_OK;
+            }
+
+            if (res == E_OK) {
+                res = SoAd_Remote_Acquire(SoAd_Instance, remote, &id_remote);
+            }
+
+            if (res == E_OK) {
+                SoAd_SoConStatusType* status_connected = &SoAd_Instance->connections[id_connected];
+                SOAD_CFG_ATOMIC_STORE(&status_connected->socket_id, socket_id_connected);
+                SoAd_SoCon_SetRemote(SoAd_Instance, id_connected, id_remote);
+                SoAd_SoCon_EnterState(SoAd_Instance, id_connected, SOAD_SOCON_ONLINE);
+            }
+        }
+    }
+
+    return res;
+}
+
+void SoAd_TcpConnected(
+        TcpIp_SocketIdType          socket_id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id;
+    Std_ReturnType   res;
+
+    res = SoAd_SoCon_Lookup(SoAd_Instance, &id, socket_id);
+    if (res == E_OK) {
+        const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+        const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+        SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id];
+
+        if (group->initiate) {
+            if (status->state != SOAD_SOCON_ONLINE) {
+                if (group->protocol == TCPIP_IPPROTO_TCP) {
+                    SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_ONLINE);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy the next part of a gathered IF PDU, header first
+ */
+static BufReq_ReturnType SoAd_IfGather_Copy(SoAd_InstanceType* SoAd_Instance, uint8* buf, uint16 len)
+{
+    SoAd_IfGatherType* gather = &SoAd_Instance->if_gather;
+    uint16             part;
+
+    if ((uint32)len > ((uint32)gather->header_left + gather->data_left)) {
+        return BUFREQ_E_NOT_OK;
+    }
+
+    part = (len < gather->header_left) ? len : gather->header_left;
+    memcpy(buf, &gather->header[SOAD_PDUHEADER_SIZE - gather->header_left], part);
+    gather->header_left -= (uint8)part;
+
+    memcpy(buf + part, gather->data, (size_t)(len - part));
+    gather->data      += len - part;
+    gather->data_left -= (uint32)len - part;
+    return BUFREQ_OK;
+}
+
+BufReq_ReturnType SoAd_CopyTxData(
+        TcpIp_SocketIdType          socket_id,
+        uint8*                      buf,
+        uint16                      len
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    Std_ReturnType       res;
+    BufReq_ReturnType    res_buf;
+    SoAd_SoConIdType     id_con;
+    res = SoAd_SoCon_Lookup(SoAd_Instance, &id_con, socket_id);
+    if ((res != E_OK) && (SoAd_Instance->if_gather.connection != SOAD_SOCONID_INVALID)) {
+        id_con = SoAd_Instance->if_gather.connection;
+        res    = E_OK;
+    } else if ((res != E_OK) && (SoAd_Instance->tx_copy != SOAD_SOCONID_INVALID)) {
+        /* a group socket copies for the connection transmitting on it */
+        id_con = SoAd_Instance->tx_copy;
+        res    = E_OK;
+    }
+
+    if ((res == E_OK) && (SoAd_Instance->if_gather.connection == id_con)) {
+        res_buf = SoAd_IfGather_Copy(SoAd_Instance, buf, len);
+    } else if ((res == E_OK) && (SoAd_Instance->connections[id_con].tx_route != NULL_PTR)) {
+        const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id_con];
+        SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id_con];
+        PduInfoType                 info;
+        PduLengthType               available = status->tx_available;
+        uint16                      part      = 0u;
+
+        if (status->tx_header_left != 0u) {
+            /* the header goes ahead of the first payload byte */
+            part = (len < status->tx_header_left) ? len : status->tx_header_left;
+            memcpy(buf, &status->tx_header[SOAD_PDUHEADER_SIZE - status->tx_header_left], part);
+            status->tx_header_left -= (uint8)part;
+        }
+
+        info.SduLength  = len - part;
+        info.SduDataPtr = buf + part;
+
+        if (info.SduLength == 0u) {
+            res_buf = BUFREQ_OK;
+        } else {
+            res_buf = status->tx_route->upper->copy_tx_data(status->tx_route->pdu_id
+                                                           , &info
+                                                           , NULL_PTR
+                                                           , &available);
+        }
+        if (res_buf == BUFREQ_OK) {
+            const SoAd_SoGrpConfigType* group = SoAd_Instance->config->groups[config->group];
+
+            status->tx_available = available;
+            if (SoAd_Instance->tx_copy == id_con) {
+                SoAd_Instance->tx_copied += len;
+            }
+            if (status->tx_stream == FALSE) {
+                status->tx_remain -= (info.SduLength < status->tx_remain) ? info.SduLength : status->tx_remain;
+                if (status->tx_available > status->tx_remain) {
+                    status->tx_available = status->tx_remain;
+                }
+            }
+            SOAD_MEAS_INC(connections[id_con].tx_bytes, info.SduLength);
+            if (group->tp_tx_timeout != 0u) {
+                SoAd_Timer_Arm(SoAd_Instance, SOAD_TIMER_ID(id_con, SOAD_TIMER_TPTX), group->tp_tx_timeout);
+            }
+        }
+    } else {
+        res_buf = BUFREQ_E_NOT_OK;
+    }
+
+    return res_buf;
+}
+
+/**
+ * @brief Add the tokens earned since the last refill, up to the burst size
+ */
+static void SoAd_TxShape_Refill(SoAd_InstanceType* SoAd_Instance, SoAd_TxShapeType* shape, const SoAd_TxShapeConfigType* config)
+{
+    uint32 now = SoAd_Instance->timer_wheel.now;
+    uint32 periods;
+    uint32 room;
+
+    if ((now - shape->refill) >= config->period) {
+        periods = (now - shape->refill) / config->period;
+        room    = config->burst - (uint32)shape->tokens;
+        if (periods > (room / config->rate)) {
+            shape->tokens = (sint32)config->burst;
+        } else {
+            shape->tokens += (sint32)(periods * config->rate);
+        }
+        shape->refill += periods * config->period;
+    }
+}
+
+/**
+ * @brief Check if both the connection and its group have transmit budget left
+ */
+static boolean SoAd_TxShape_Ready(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+    boolean                     res    = TRUE;
+
+    if (config->tx_shape.rate != 0u) {
+        SoAd_TxShape_Refill(SoAd_Instance, &SoAd_Instance->connections[id].tx_shape, &config->tx_shape);
+        if (SoAd_Instance->connections[id].tx_shape.tokens <= 0) {
+            res = FALSE;
+        }
+    }
+
+    if (group->tx_shape.rate != 0u) {
+        SoAd_TxShape_Refill(SoAd_Instance, &SoAd_Instance->groups[config->group].tx_shape, &group->tx_shape);
+        if (SoAd_Instance->groups[config->group].tx_shape.tokens <= 0) {
+            res = FALSE;
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Most bytes the connection may send at once, tokens left and burst size of both shapers
+ *
+ * Only meaningful after SoAd_TxShape_Ready refilled the buckets.
+ */
+static uint32 SoAd_TxShape_Room(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+    uint32                      room   = (uint32)-1;
+    uint32                      part;
+    sint32                      tokens;
+
+    if (config->tx_shape.rate != 0u) {
+        tokens = SoAd_Instance->connections[id].tx_shape.tokens;
+        part   = (tokens > 0) ? (uint32)tokens : 0u;
+        part   = (part < config->tx_shape.burst) ? part : config->tx_shape.burst;
+        room   = (part < room) ? part : room;
+    }
+
+    if (group->tx_shape.rate != 0u) {
+        tokens = SoAd_Instance->groups[config->group].tx_shape.tokens;
+        part   = (tokens > 0) ? (uint32)tokens : 0u;
+        part   = (part < group->tx_shape.burst) ? part : group->tx_shape.burst;
+        room   = (part < room) ? part : room;
+    }
+    return room;
+}
+
+static void SoAd_TxShape_Charge(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, uint32 len)
+{
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+
+    if (config->tx_shape.rate != 0u) {
+        SoAd_Instance->connections[id].tx_shape.tokens -= (sint32)len;
+    }
+
+    if (group->tx_shape.rate != 0u) {
+        SoAd_Instance->groups[config->group].tx_shape.tokens -= (sint32)len;
+    }
+}
+
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+/**
+ * @brief Route of an IF PDU if its upper layer wants a confirmation, else NULL_PTR
+ */
+static const SoAd_PduRouteType* SoAd_InFlight_Tracked(const SoAd_PduRouteType* route)
+{
+    const SoAd_IfTxType* upper = (route != NULL_PTR) ? route->upper_if : NULL_PTR;
+
+    if ((upper != NULL_PTR)
+    &&  ((upper->tx_confirmation != NULL_PTR) || (upper->tx_confirmations != NULL_PTR))) {
+        return route;
+    }
+    return NULL_PTR;
+}
+
+static SoAd_InFlightRecordType* SoAd_InFlight_Tail(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    SoAd_InFlightType* ring = &SoAd_Instance->inflight[id];
+
+    if (ring->count == 0u) {
+        return NULL_PTR;
+    }
+    return &ring->records[(ring->head + ring->count - 1u) % SOAD_CFG_TX_INFLIGHT_SIZE];
+}
+
+/**
+ * @brief Check if a transmission on a connection can be tracked
+ * @param route IF route sent, NULL_PTR for TP data
+ */
+static boolean SoAd_InFlight_Room(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, const SoAd_PduRouteType* route)
+{
+    const SoAd_SoConConfigType*    config = SoAd_Instance->config->connections[id];
+    const SoAd_InFlightRecordType* tail;
+
+    route = SoAd_InFlight_Tracked(route);
+    if (route == NULL_PTR) {
+        /* only TCP needs to count bytes nobody waits for */
+        if (SoAd_Instance->config->groups[config->group]->protocol != TCPIP_IPPROTO_TCP) {
+            return TRUE;
+        }
+
+        tail = SoAd_InFlight_Tail(SoAd_Instance, id);
+        if ((tail != NULL_PTR) && (tail->route == NULL_PTR)) {
+            return TRUE;
+        }
+    }
+    return (SoAd_Instance->inflight[id].count < SOAD_CFG_TX_INFLIGHT_SIZE) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Track a transmission accepted by TcpIp, room must have been checked
+ */
+static void SoAd_InFlight_Push(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, const SoAd_PduRouteType* route, uint32 length)
+{
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    SoAd_InFlightType*          ring   = &SoAd_Instance->inflight[id];
+    SoAd_InFlightRecordType*    record;
+
+    route = SoAd_InFlight_Tracked(route);
+    if (SoAd_Instance->config->groups[config->group]->protocol != TCPIP_IPPROTO_TCP) {
+        if (route == NULL_PTR) {
+            return;
+        }
+        SoAd_SoConList_Push(&SoAd_Instance->inflight_list, id);
+    } else if (route == NULL_PTR) {
+        record = SoAd_InFlight_Tail(SoAd_Instance, id);
+        if ((record != NULL_PTR) && (record->route == NULL_PTR)) {
+            record->length += length;
+            return;
+        }
+    } else {
+        /* tracked TCP PDU */
+    }
+
+    record         = &ring->records[(ring->head + ring->count) % SOAD_CFG_TX_INFLIGHT_SIZE];
+    record->route  = route;
+    record->length = length;
+    ring->count++;
+}
+
+/**
+ * @brief Report completed IF PDUs, one call per upper layer taking batches
+ *
+ * Works on a copy owned by the caller, so confirmations may transmit
+ * and complete further PDUs meanwhile.
+ */
+static void SoAd_InFlight_Confirm(const SoAd_PduRouteType** done, uint16 count)
+{
+    const SoAd_IfTxType* upper;
+    PduIdType            ids[SOAD_CFG_TX_INFLIGHT_SIZE];
+    uint16               index;
+    uint16               inner;
+    uint16               used;
+
+    for (index = 0u; index < count; ++index) {
+        if (done[index] == NULL_PTR) {
+            continue;
+        }
+
+        upper = done[index]->upper_if;
+        if (upper->tx_confirmations != NULL_PTR) {
+            used = 0u;
+            for (inner = index; inner < count; ++inner) {
+                if ((done[inner] != NULL_PTR)
+                &&  (done[inner]->upper_if == upper)) {
+                    ids[used++] = done[inner]->pdu_id;
+                    done[inner] = NULL_PTR;
+                }
+            }
+            upper->tx_confirmations(ids, used);
+        } else {
+            upper->tx_confirmation(done[index]->pdu_id);
+            done[index] = NULL_PTR;
+        }
+    }
+}
+
+/**
+ * @brief Release acknowledged bytes of a connection and confirm the IF PDUs completed
+ *
+ * @param records most records to release, later ones stay for the next acknowledgement
+ */
+static void SoAd_InFlight_Ack(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, uint32 length, uint16 records)
+{
+    SoAd_InFlightType*       ring = &SoAd_Instance->inflight[id];
+    SoAd_InFlightRecordType* record;
+    const SoAd_PduRouteType* done[SOAD_CFG_TX_INFLIGHT_SIZE];
+    uint16                   count = 0u;
+
+    for (; (records > 0u) && (ring->count > 0u); --records) {
+        record = &ring->records[ring->head];
+        if (record->length > length) {
+            record->length -= length;
+            break;
+        }
+
+        length -= record->length;
+        if (record->route != NULL_PTR) {
+            done[count++] = record->route;
+        }
+        ring->head = (uint16)((ring->head + 1u) % SOAD_CFG_TX_INFLIGHT_SIZE);
+        ring->count--;
+    }
+
+    /* ring is consistent before upper layers may transmit again */
+    SoAd_InFlight_Confirm(done, count);
+}
+
+/**
+ * @brief Confirm UDP transmissions, TcpIp reports no acknowledgement for them
+ *
+ * Only transmissions made before the call are confirmed, ones made
+ * from the confirmations wait for the next main function.
+ */
+static void SoAd_InFlight_MainFunction(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_SoConListType pending = SoAd_Instance->inflight_list;
+    uint16             records[SOAD_CFG_CONNECTION_COUNT];
+    SoAd_SoConIdType   index;
+    SoAd_SoConIdType   id;
+
+    SoAd_SoConList_Init(&SoAd_Instance->inflight_list);
+    for (index = 0u; index < pending.count; ++index) {
+        id          = pending.items[index];
+        records[id] = SoAd_Instance->inflight[id].count;
+    }
+
+    for (index = 0u; index < pending.count; ++index) {
+        id = pending.items[index];
+        SoAd_InFlight_Ack(SoAd_Instance, id, (uint32)-1, records[id]);
+    }
+}
+#else
+/**
+ * @brief Note an IF PDU accepted by TcpIp for confirmation from the main function
+ */
+static void SoAd_IfConfirm_Push(SoAd_InstanceType* SoAd_Instance, const SoAd_PduRouteType* route)
+{
+    const SoAd_IfTxType* upper = route->upper_if;
+
+    if ((upper == NULL_PTR)
+    ||  ((upper->tx_confirmation == NULL_PTR) && (upper->tx_confirmations == NULL_PTR))) {
+        return;
+    }
+
+    if (SoAd_Instance->if_confirm_due[route->pdu_id]++ == 0u) {
+        SoAd_Instance->if_confirm[(SoAd_Instance->if_confirm_head + SoAd_Instance->if_confirm_count) % SOAD_CFG_PDUROUTE_COUNT] = route;
+        SoAd_Instance->if_confirm_count++;
+    }
+}
+
+/**
+ * @brief Confirm IF PDUs sent since the previous main function
+ *
+ * PDUs transmitted again from a confirmation are confirmed by the
+ * next main function.
+ */
+static void SoAd_IfConfirm_MainFunction(SoAd_InstanceType* SoAd_Instance)
+{
+    const SoAd_PduRouteType* route;
+    uint16                   count = SoAd_Instance->if_confirm_count;
+    uint16                   due;
+
+    for (; count > 0u; --count) {
+        route = SoAd_Instance->if_confirm[SoAd_Instance->if_confirm_head];
+        SoAd_Instance->if_confirm_head = (uint16)((SoAd_Instance->if_confirm_head + 1u) % SOAD_CFG_PDUROUTE_COUNT);
+        SoAd_Instance->if_confirm_count--;
+
+        due = SoAd_Instance->if_confirm_due[route->pdu_id];
+        SoAd_Instance->if_confirm_due[route->pdu_id] = 0u;
+
+        for (; due > 0u; --due) {
+            if (route->upper_if->tx_confirmations != NULL_PTR) {
+                route->upper_if->tx_confirmations(&route->pdu_id, 1u);
+            } else {
+                route->upper_if->tx_confirmation(route->pdu_id);
+            }
         }
     }
+}
+#endif
+
+/**
+ * @brief Socket a connection transmits on, its own or the one of its group
+ */
+static TcpIp_SocketIdType SoAd_SoCon_Socket(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    TcpIp_SocketIdType socket_id = SOAD_CFG_ATOMIC_LOAD(&SoAd_Instance->connections[id].socket_id);
+
+    if (socket_id == TCPIP_SOCKETID_INVALID) {
+        socket_id = SOAD_CFG_ATOMIC_LOAD(&SoAd_Instance->groups[SoAd_Instance->config->connections[id]->group].socket_id);
+    }
+    return socket_id;
+}
+
+/**
+ * @brief Send an IF PDU on the online connection of its route
+ */
+static Std_ReturnType SoAd_IfTransmit_Send(SoAd_InstanceType* SoAd_Instance, const SoAd_PduRouteType* route, const uint8* data, PduLengthType len)
+{
+    Std_ReturnType              res;
+    SoAd_SoConIdType            id_con = route->destination.connection;
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id_con];
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id_con];
+    const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+    const uint8*                tx_data = data;
+    uint32                      wire    = len;
+#if(SOAD_CFG_CONCURRENT_TX == STD_ON)
+    TcpIp_SockAddrStorageType   remote;
+#endif
+
+    if (group->header == TRUE) {
+        /* TcpIp gathers header and payload, see SoAd_IfGather_Copy */
+        SoAd_PduHeader_Write(SoAd_Instance->if_gather.header, route->destination.header_id, len);
+        SoAd_Instance->if_gather.header_left = SOAD_PDUHEADER_SIZE;
+        SoAd_Instance->if_gather.data        = data;
+        SoAd_Instance->if_gather.data_left   = len;
+        SoAd_Instance->if_gather.connection  = id_con;
+        tx_data = NULL_PTR;
+        wire    = (uint32)len + SOAD_PDUHEADER_SIZE;
+    }
 
-    if (SoAd_Config->pdu_routes[low]->pdu_id == id) {
-        *route = SoAd_Config->pdu_routes[low];
-        res = E_OK;
-    } else {
+    if (SOAD_INFLIGHT_ROOM(id_con, route) == FALSE) {
+        /* refused like a full send buffer */
         res = E_NOT_OK;
+    } else {
+        switch(group->protocol) {
+            case TCPIP_IPPROTO_UDP:
+                if (wire > 0xffffu) {
+                    res = E_NOT_OK;
+                } else {
+#if(SOAD_CFG_CONCURRENT_TX == STD_ON)
+                    SoAd_SoCon_ReadRemote(SoAd_Instance, id_con, &remote);
+                    res = TcpIp_UdpTransmit(SoAd_SoCon_Socket(SoAd_Instance, id_con)
+                                          , tx_data
+                                          , &remote.base
+                                          , (uint16)wire);
+#else
+                    res = TcpIp_UdpTransmit(SoAd_SoCon_Socket(SoAd_Instance, id_con)
+                                          , tx_data
+                                          , SoAd_Remote_Address(SoAd_Instance, status->remote)
+                                          , (uint16)wire);
+#endif
+                }
+                break;
+            case TCPIP_IPPROTO_TCP:
+                res = TcpIp_TcpTransmit(SOAD_CFG_ATOMIC_LOAD(&status->socket_id)
+                                      , tx_data
+                                      , wire
+                                      , TRUE);
+                break;
+            default:
+                res = E_NOT_OK;
+                break;
+        }
+    }
+
+    if (group->header == TRUE) {
+        SoAd_Instance->if_gather.connection = SOAD_SOCONID_INVALID;
+    }
+
+    if (res == E_OK) {
+        SoAd_TxShape_Charge(SoAd_Instance, id_con, wire);
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+        SoAd_InFlight_Push(SoAd_Instance, id_con, route, wire);
+#else
+        SoAd_IfConfirm_Push(SoAd_Instance, route);
+#endif
+    }
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    /* drops are counted by the caller, once the PDU is given up */
+    if (res == E_OK) {
+        SoAd_Measure_Tx(SoAd_Instance, route->pdu_id, id_con, len, res);
     }
+#endif
     return res;
 }
 
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
 /**
- * @brief Performs check to see if socket should go online
- * @req   SWS_SoAd_00592
+ * @brief Hold a copy of an IF PDU until the shapers of its connection allow sending
  */
-static void SoAd_RxIndication_RemoteOnline(SoAd_SoConIdType con_id, const TcpIp_SockAddrType* remote, TcpIp_SockAddrStorageType* restore, SoAd_SoConStateType* state)
+static Std_ReturnType SoAd_IfHeld_Push(SoAd_InstanceType* SoAd_Instance, const SoAd_PduRouteType* route, const PduInfoType* pdu_info)
 {
-    SoAd_SoConStatusType*       con_status = &SoAd_SoConStatus[con_id];
+    SoAd_IfHeldType*            held   = &SoAd_Instance->if_held[route->pdu_id];
+    SoAd_SoConIdType            id_con = route->destination.connection;
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id_con];
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id_con];
+    uint16                      length;
+
+    if (held->buffer != SOAD_BUFFERID_INVALID) {
+        /* latest value wins, keeping the position of the held one */
+        length = SoAd_Instance->buffer_pool.buffers[held->buffer].length;
+        SoAd_Instance->buffer_pool.buffers[held->buffer].length = 0u;
+        if (SoAd_Buffer_Append(SoAd_Instance, id_con, &held->buffer, pdu_info->SduDataPtr, pdu_info->SduLength) != E_OK) {
+            SoAd_Instance->buffer_pool.buffers[held->buffer].length = length;
+            return E_NOT_OK;
+        }
+        return E_OK;
+    }
 
-    *state = con_status->state;
-    if (con_status->state != SOAD_SOCON_ONLINE) {
-        const SoAd_SoConConfigType* con_config = SoAd_Config->connections[con_id];
-        const SoAd_SoGrpConfigType* grp_config = SoAd_Config->groups[con_config->group];
-        if (grp_config->protocol == TCPIP_IPPROTO_UDP) {
-            if (grp_config->listen_only == FALSE) {
-                if (SoAd_SockAddrWildcard(&con_status->remote.base) == TRUE) {
-                    /* TODO - (4) SoAdSocketMsgAcceptanceFilterEnabled */
-                    /* TODO - (6) Acceptance policy */
-                    *restore = con_status->remote;
-                    SoAd_SockAddrCopy(&con_status->remote, remote);
-                    SoAd_SoCon_EnterState(con_id, SOAD_SOCON_ONLINE);
-                }
+    if ((config->if_retry != 0u) && (status->if_count >= config->if_retry)) {
+        return E_NOT_OK;
+    }
+
+    if (SoAd_Buffer_Append(SoAd_Instance, id_con, &held->buffer, pdu_info->SduDataPtr, pdu_info->SduLength) != E_OK) {
+        return E_NOT_OK;
+    }
+
+    held->route = route;
+    held->next  = SOAD_PDUID_INVALID;
+    if (status->if_tail == SOAD_PDUID_INVALID) {
+        status->if_head = route->pdu_id;
+    } else {
+        SoAd_Instance->if_held[status->if_tail].next = route->pdu_id;
+    }
+    status->if_tail = route->pdu_id;
+    status->if_count++;
+
+    SoAd_TxSchedule_Push(SoAd_Instance, id_con);
+    return E_OK;
+}
+
+/**
+ * @brief Send held IF PDUs of a connection in order while its shapers allow
+ *
+ * A PDU refused by TcpIp stays first in line for the next main function
+ * if the connection retries, so later PDUs don't overtake it.
+ */
+static void SoAd_IfHeld_Process(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id];
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    const SoAd_PduRouteType*    route;
+    SoAd_IfHeldType*            held;
+    Std_ReturnType              res;
+
+    while ((status->if_head != SOAD_PDUID_INVALID) && (SoAd_TxShape_Ready(SoAd_Instance, id) == TRUE)) {
+        held  = &SoAd_Instance->if_held[status->if_head];
+        route = held->route;
+
+        if (SOAD_ROUTING_ENABLED(route->destination.routing_groups, id)) {
+            res = SoAd_IfTransmit_Send(SoAd_Instance, route
+                                     , SoAd_Buffer_Data(SoAd_Instance, held->buffer)
+                                     , SoAd_Instance->buffer_pool.buffers[held->buffer].length);
+            if ((res != E_OK) && (config->if_retry != 0u)) {
+                break;
             }
+        } else {
+            res = E_NOT_OK;
+        }
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+        if (res != E_OK) {
+            SoAd_Measure_Tx(SoAd_Instance, route->pdu_id, id, SoAd_Instance->buffer_pool.buffers[held->buffer].length, res);
+        }
+#endif
+
+        status->if_head = held->next;
+        if (status->if_head == SOAD_PDUID_INVALID) {
+            status->if_tail = SOAD_PDUID_INVALID;
         }
+        status->if_count--;
+        SoAd_Buffer_Free(SoAd_Instance, held->buffer);
+        held->buffer = SOAD_BUFFERID_INVALID;
     }
 }
 
 /**
- * @brief Revert remote address change if state mismatches
- * @req SWS_SoAd_00710
+ * @brief Drop held IF PDUs of a connection
  */
-static void SoAd_RxIndication_RemoteRevert(SoAd_SoConIdType con_id, const TcpIp_SockAddrStorageType* remote, const SoAd_SoConStateType state)
+static void SoAd_IfHeld_Clear(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    SoAd_SoConStatusType* con_status = &SoAd_SoConStatus[con_id];
-
-    if (con_status->state != state) {
-        con_status->remote = *remote;
-        SoAd_SoCon_EnterState(con_id, state);
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+    SoAd_IfHeldType*      held;
+
+    while (status->if_head != SOAD_PDUID_INVALID) {
+        held            = &SoAd_Instance->if_held[status->if_head];
+        status->if_head = held->next;
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+        SoAd_Measure_Tx(SoAd_Instance, held->route->pdu_id, id, SoAd_Instance->buffer_pool.buffers[held->buffer].length, E_NOT_OK);
+#endif
+        SoAd_Buffer_Free(SoAd_Instance, held->buffer);
+        held->buffer    = SOAD_BUFFERID_INVALID;
     }
+    status->if_tail  = SOAD_PDUID_INVALID;
+    status->if_count = 0u;
 }
+#endif
 
-Std_ReturnType SoAd_RxIndication_SoCon(
-        SoAd_SoConIdType            con_id,
-        uint8*                      buf,
-        uint16                      len
-    )
+/**
+ * @brief Send an IF PDU on the connection of its route, or hold it for the main function
+ *
+ * PDUs are held while over the shaping budget, and with retries
+ * configured also while offline or refused by TcpIp.
+ */
+static Std_ReturnType SoAd_IfTransmit_Route(SoAd_InstanceType* SoAd_Instance, const SoAd_PduRouteType* route, const PduInfoType* pdu_info)
 {
-    PduInfoType                 info;
-    const SoAd_SoConStatusType* con_sts = &SoAd_SoConStatus[con_id];
+    Std_ReturnType              res;
+    SoAd_SoConIdType            id_con = route->destination.connection;
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id_con];
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id_con];
+    boolean                     hold;
 
-    /* TODO - header id handling */
+    if (!SOAD_ROUTING_ENABLED(route->destination.routing_groups, id_con)) {
+        return E_NOT_OK;
+    }
 
+    if (SOAD_CFG_ATOMIC_LOAD(&status->state) != SOAD_SOCON_ONLINE) {
+        res  = E_NOT_OK;
+        hold = (config->if_retry != 0u) ? TRUE : FALSE;
+    } else if ((status->if_head == SOAD_PDUID_INVALID) && (SoAd_TxShape_Ready(SoAd_Instance, id_con) == TRUE)) {
+        res  = SoAd_IfTransmit_Send(SoAd_Instance, route, pdu_info->SduDataPtr, pdu_info->SduLength);
+        if (res == E_OK) {
+            return res;
+        }
+        hold = (config->if_retry != 0u) ? TRUE : FALSE;
+    } else {
+        /* queued behind earlier held PDUs */
+        res  = E_NOT_OK;
+        hold = TRUE;
+    }
 
-    if (con_sts->rx_route) {
-        PduLengthType     buf_len;
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    if (hold == TRUE) {
+        res = SoAd_IfHeld_Push(SoAd_Instance, route, pdu_info);
+    }
+#else
+    (void)hold;
+#endif
 
-        info.SduDataPtr = NULL_PTR;
-        info.SduLength  = 0u;
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    if (res != E_OK) {
+        SoAd_Measure_Tx(SoAd_Instance, route->pdu_id, id_con, pdu_info->SduLength, res);
+    }
+#endif
+    return res;
+}
 
-        if (con_sts->rx_route->destination.upper->copy_rx_data(
-                con_sts->rx_route->destination.pdu
-              , &info
-              , &buf_len) != BUFREQ_OK) {
-            return E_NOT_OK;
-        }
+Std_ReturnType SoAd_IfTransmit(
+        PduIdType                   pdu_id,
+        const PduInfoType*          pdu_info
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    Std_ReturnType              res;
+    const SoAd_PduRouteType*    route = NULL_PTR;
 
-        /* TODO check for internal buffer */
-        if (buf_len < len) {
-            return E_NOT_OK;
-        }
+    /**
+     * @req SWS_SoAd_00213
+     */
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_IFTRANSMIT
+                     , SOAD_E_NOTINIT);
 
+    /**
+     * @req SWS_SoAd_00214
+     */
+    SOAD_DET_CHECK_RET(pdu_id < SOAD_CFG_PDUROUTE_COUNT
+                     , SOAD_API_IFTRANSMIT
+                     , SOAD_E_INV_PDUID);
 
-        info.SduLength = len;
-        info.SduDataPtr = buf;
+    /**
+     * @req SWS_SoAd_00653-TODO
+     */
 
-        if (con_sts->rx_route->destination.upper->copy_rx_data(
-                con_sts->rx_route->destination.pdu
-              , &info
-              , &buf_len) != BUFREQ_OK) {
-            return E_NOT_OK;
-        }
+    SOAD_TRACE_ENTER(SOAD_TRACE_IFTRANSMIT);
+
+    res = SoAd_GetPduRoute(SoAd_Instance, pdu_id, &route);
 
+    if (res == E_OK) {
+        res = SoAd_IfTransmit_Route(SoAd_Instance, route, pdu_info);
     }
 
-    return E_OK;
+    SOAD_TRACE_EXIT(SOAD_TRACE_IFTRANSMIT
+                  , route != NULL_PTR ? route->destination.connection : SOAD_SOCONID_INVALID
+                  , pdu_id, pdu_info->SduLength, res);
+    return res;
 }
 
-void SoAd_RxIndication(
-        TcpIp_SocketIdType          socket_id,
-        const TcpIp_SockAddrType*   remote,
-        uint8*                      buf,
-        uint16                      len
+
+Std_ReturnType SoAd_TpTransmit(
+        PduIdType                   pdu_id,
+        const PduInfoType*          pdu_info
     )
 {
-    SoAd_SoConIdType id_con;
-    Std_ReturnType   res;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    Std_ReturnType              res;
+    const SoAd_PduRouteType*    route;
 
     /**
-     * @req SWS_SoAd_00264
+     * @req SWS_SoAd_00224
      */
-    SOAD_DET_CHECK_RET_0(SoAd_Config != NULL_PTR
-                       , SOAD_API_RXINDICATION
-                       , SOAD_E_NOTINIT);
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_TPTRANSMIT
+                     , SOAD_E_NOTINIT);
 
     /**
-     * @req SWS_SoAd_00264
+     * @req SWS_SoAd_00237
      */
-    SOAD_DET_CHECK_RET_0(remote != NULL_PTR
-                       , SOAD_API_RXINDICATION
-                       , SOAD_E_INV_ARG);
+    SOAD_DET_CHECK_RET(pdu_id < SOAD_CFG_PDUROUTE_COUNT
+                     , SOAD_API_TPTRANSMIT
+                     , SOAD_E_INV_PDUID);
 
+    /**
+     * @req SWS_SoAd_00650-TODO
+     */
 
-    res = SoAd_SoCon_Lookup(&id_con, socket_id);
-    if (res != E_OK) {
-        SoAd_SoGrpIdType id_grp;
-        res = SoAd_SoGrp_Lookup(&id_grp, socket_id);
-        if (res == E_OK) {
-            res = SoAd_SoCon_Lookup_FreeSocket(&id_con, id_grp, remote);
-        }
+    SOAD_TRACE_ENTER(SOAD_TRACE_TPTRANSMIT);
+
+    res = SoAd_GetPduRoute(SoAd_Instance, pdu_id, &route);
+
+    if ((res == E_OK)
+    &&  !SOAD_ROUTING_ENABLED(route->destination.routing_groups, route->destination.connection)) {
+        res = E_NOT_OK;
     }
 
     if (res == E_OK) {
-        TcpIp_SockAddrStorageType   revert_remote;
-        SoAd_SoConStateType         revert_state;
-        SoAd_RxIndication_RemoteOnline(id_con, remote, &revert_remote, &revert_state);
+        const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[route->destination.connection];
+        const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+        SoAd_SoConStatusType*       status = &SoAd_Instance->connections[route->destination.connection];
 
-        res = SoAd_RxIndication_SoCon(id_con, buf, len);
+        uint32                      header = (group->header == TRUE) ? SOAD_PDUHEADER_SIZE : 0u;
 
-        if (res != E_OK) {
-            SoAd_RxIndication_RemoteRevert(id_con, &revert_remote, revert_state);
+        /* one TP PDU at a time, a datagram or a header needs a known length that fits */
+        if ((status->tx_route != NULL_PTR)
+        ||  ((header != 0u) && (pdu_info->SduLength == 0u))
+        ||  ((group->protocol == TCPIP_IPPROTO_UDP)
+          && ((pdu_info->SduLength == 0u) || (((uint32)pdu_info->SduLength + header) > 0xffffu)))) {
+            res = E_NOT_OK;
+        } else {
+            /* a length of 0 streams until the upper layer runs dry */
+            status->tx_route     = route;
+            status->tx_remain    = pdu_info->SduLength;
+            status->tx_available = 0u;
+            status->tx_stream    = (pdu_info->SduLength == 0u) ? TRUE : FALSE;
+            status->tx_header_left = (uint8)header;
+            if (header != 0u) {
+                SoAd_PduHeader_Write(status->tx_header, route->destination.header_id, pdu_info->SduLength);
+            }
+            SoAd_TxSchedule_Push(SoAd_Instance, route->destination.connection);
+
+            if (group->tp_tx_timeout != 0u) {
+                SoAd_Timer_Arm(SoAd_Instance, SOAD_TIMER_ID(route->destination.connection, SOAD_TIMER_TPTX), group->tp_tx_timeout);
+            }
         }
-    } else {
-        /**
-         * @req SWS_SoAd_00267
-         */
-        SOAD_DET_ERROR(SOAD_API_RXINDICATION
+    }
+
+    SOAD_TRACE_EXIT(SOAD_TRACE_TPTRANSMIT
+                  , (res == E_OK) ? route->destination.connection : SOAD_SOCONID_INVALID
+                  , pdu_id, pdu_info->SduLength, res);
+    return res;
+}
+
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 0u)
+Std_ReturnType SoAd_EnableRouting(
+        SoAd_RoutingGroupIdType     id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id_con;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_ENABLEROUTING
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_ROUTINGGROUP_COUNT
+                     , SOAD_API_ENABLEROUTING
+                     , SOAD_E_INV_ARG);
+
+    for (id_con = 0u; id_con < SOAD_CFG_CONNECTION_COUNT; ++id_con) {
+        SOAD_CFG_ATOMIC_STORE(&SoAd_Instance->routing[id_con], SoAd_Instance->routing[id_con] | ((SoAd_RoutingGroupMaskType)1u << id));
+    }
+    return E_OK;
+}
+
+Std_ReturnType SoAd_EnableSpecificRouting(
+        SoAd_RoutingGroupIdType     id,
+        SoAd_SoConIdType            id_con
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_ENABLESPECIFICROUTING
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_ROUTINGGROUP_COUNT
+                     , SOAD_API_ENABLESPECIFICROUTING
+                     , SOAD_E_INV_ARG);
+
+    SOAD_DET_CHECK_RET(id_con < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_ENABLESPECIFICROUTING
+                     , SOAD_E_INV_SOCKETID);
+
+    SOAD_CFG_ATOMIC_STORE(&SoAd_Instance->routing[id_con], SoAd_Instance->routing[id_con] | ((SoAd_RoutingGroupMaskType)1u << id));
+    return E_OK;
+}
+
+Std_ReturnType SoAd_DisableRouting(
+        SoAd_RoutingGroupIdType     id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType id_con;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_DISABLEROUTING
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_ROUTINGGROUP_COUNT
+                     , SOAD_API_DISABLEROUTING
+                     , SOAD_E_INV_ARG);
+
+    for (id_con = 0u; id_con < SOAD_CFG_CONNECTION_COUNT; ++id_con) {
+        SOAD_CFG_ATOMIC_STORE(&SoAd_Instance->routing[id_con], SoAd_Instance->routing[id_con] & ~((SoAd_RoutingGroupMaskType)1u << id));
+    }
+    return E_OK;
+}
+
+/**
+ * @brief Fetch and send every enabled IF PDU of a routing group
+ * @return E_OK if all PDUs were sent
+ */
+Std_ReturnType SoAd_IfRoutingGroupTransmit(
+        SoAd_RoutingGroupIdType     id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    const SoAd_RoutingGroupMaskType mask = (SoAd_RoutingGroupMaskType)1u << id;
+    Std_ReturnType                  res  = E_OK;
+    PduIdType                       index;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_IFROUTINGGROUPTRANSMIT
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_ROUTINGGROUP_COUNT
+                     , SOAD_API_IFROUTINGGROUPTRANSMIT
+                     , SOAD_E_INV_ARG);
+
+    for (index = 0u; index < SOAD_CFG_PDUROUTE_COUNT; ++index) {
+        const SoAd_PduRouteType* route = SoAd_Instance->config->pdu_routes[index];
+        PduInfoType              info;
+
+        if (((route->destination.routing_groups & mask & SoAd_Instance->routing[route->destination.connection]) == 0u)
+        ||  (route->upper_if == NULL_PTR)) {
+            continue;
+        }
+
+        info.SduDataPtr = SoAd_Instance->iftrigger_buffer;
+        info.SduLength  = SOAD_CFG_IFTRIGGER_SIZE;
+        if ((route->upper_if->trigger_transmit(route->pdu_id, &info) != E_OK)
+        ||  (SoAd_IfTransmit_Route(SoAd_Instance, route, &info) != E_OK)) {
+            res = E_NOT_OK;
+        }
+    }
+    return res;
+}
+#endif
+
+/**
+ * @brief Queue an open or close request of a connection for the main function
+ */
+static void SoAd_SoCon_Request(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, boolean open, boolean abort)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+
+    /* the latest request wins */
+    status->request_open  = open;
+    status->request_close = (open == FALSE) ? TRUE : FALSE;
+    if (open == FALSE) {
+        status->request_abort = (status->request_abort || abort) ? TRUE : FALSE;
+    }
+    SoAd_SoConList_Push(&SoAd_Instance->requests, id);
+}
+
+/**
+ * @req SWS_SoAd_00528
+ */
+Std_ReturnType SoAd_OpenSoCon(
+        SoAd_SoConIdType            id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_OPENSOCON
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_OPENSOCON
                      , SOAD_E_INV_SOCKETID);
+
+    if (SoAd_Instance->config->groups[SoAd_Instance->config->connections[id]->group]->automatic != FALSE) {
+        return E_NOT_OK;
     }
+
+    SoAd_SoCon_Request(SoAd_Instance, id, TRUE, FALSE);
+    return E_OK;
 }
 
 /**
- * @brief Close down a socket group
- *
- * @req SWS_SoAd_00646
- * @req SWS_SoAd_00643
- *
- * Specification is unclear on how to handle sockets
- * that are in RECONNECT state, ie for example all
- * child sockets of a listening group socket. This
- * implementation will close down all group sockets
- * if the "master" socket is lost.
+ * @req SWS_SoAd_00529
  */
-static void SoAd_SoGrp_Close(SoAd_SoGrpIdType id_grp)
+Std_ReturnType SoAd_CloseSoCon(
+        SoAd_SoConIdType            id,
+        boolean                     abort
+    )
 {
-    SoAd_SoConIdType id_con;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_CLOSESOCON
+                     , SOAD_E_NOTINIT);
 
-    const SoAd_SoGrpConfigType* config_grp = SoAd_Config->groups[id_con];
-    SoAd_SoGrpStatusType* status_grp = &SoAd_SoGrpStatus[id_con];
-    status_grp->socket_id = TCPIP_SOCKETID_INVALID;
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_CLOSESOCON
+                     , SOAD_E_INV_SOCKETID);
 
-    for (id_con = 0u; id_con < SOAD_CFG_CONNECTION_COUNT; ++id_con) {
-        const SoAd_SoConConfigType* config = SoAd_Config->connections[id_con];
-        const SoAd_SoConStatusType* status = &SoAd_SoConStatus[id_con];
-        if (config->group == id_grp && status->socket_id == TCPIP_SOCKETID_INVALID) {
-            SoAd_SoCon_EnterState(id_con, SOAD_SOCON_OFFLINE);
-        }
+    if (SoAd_Instance->config->groups[SoAd_Instance->config->connections[id]->group]->automatic != FALSE) {
+        return E_NOT_OK;
     }
+
+    SoAd_SoCon_Request(SoAd_Instance, id, FALSE, abort);
+    return E_OK;
 }
 
-void SoAd_TcpIpEvent(
-        TcpIp_SocketIdType          socket_id,
-        TcpIp_EventType             event
+/**
+ * @brief Request all connections of a group to open
+ */
+Std_ReturnType SoAd_OpenSoConGroup(
+        SoAd_SoGrpIdType            id
     )
 {
-    SoAd_SoConIdType id_con;
-    SoAd_SoGrpIdType id_grp;
-    Std_ReturnType   res;
-
-    /**
-     * @req SWS_SoAd_00276
-     */
-    SOAD_DET_CHECK_RET_0(SoAd_Config != NULL_PTR
-                       , SOAD_API_TCPIPEVENT
-                       , SOAD_E_NOTINIT);
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType index;
 
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_OPENSOCONGROUP
+                     , SOAD_E_NOTINIT);
 
-    switch (event) {
-        case TCPIP_TCP_FIN_RECEIVED:
-            (void)TcpIp_Close(socket_id, FALSE);
-            break;
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTIONGROUP_COUNT
+                     , SOAD_API_OPENSOCONGROUP
+                     , SOAD_E_INV_ARG);
 
-        case TCPIP_TCP_RESET:
-        case TCPIP_TCP_CLOSED:
-        case TCPIP_UDP_CLOSED:
-            res = SoAd_SoGrp_Lookup(&id_grp, socket_id);
-            if (res == E_OK) {
-                SoAd_SoGrp_Close(id_grp);
-            } else {
-                res = SoAd_SoCon_Lookup(&id_con, socket_id);
-                if (res == E_OK) {
-                    SoAd_SoCon_EnterState(id_con, SOAD_SOCON_OFFLINE);
-                } else {
-                    /**
-                     * @req SWS_SoAd_00277
-                     */
-                    SOAD_DET_ERROR(SOAD_API_TCPIPEVENT
-                                 , SOAD_E_INV_SOCKETID);
-                }
-            }
-            break;
-        default:
-            SOAD_DET_ERROR(SOAD_API_TCPIPEVENT
-                         , SOAD_E_INV_ARG);
-            break;
+    if (SoAd_Instance->config->groups[id]->automatic != FALSE) {
+        return E_NOT_OK;
     }
 
+    for (index = SoAd_Instance->members.first[id]; index < SoAd_Instance->members.first[id + 1u]; ++index) {
+        SoAd_SoCon_Request(SoAd_Instance, SoAd_Instance->members.members[index], TRUE, FALSE);
+    }
+    return E_OK;
 }
 
-void SoAd_TxConfirmation(
-        TcpIp_SocketIdType          socket_id,
-        uint16                      len
+/**
+ * @brief Request all connections of a group to close
+ */
+Std_ReturnType SoAd_CloseSoConGroup(
+        SoAd_SoGrpIdType            id,
+        boolean                     abort
     )
 {
-    SoAd_SoConIdType id;
-    Std_ReturnType   res;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConIdType index;
 
-    res = SoAd_SoCon_Lookup(&id, socket_id);
-    if (res == E_OK) {
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_CLOSESOCONGROUP
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTIONGROUP_COUNT
+                     , SOAD_API_CLOSESOCONGROUP
+                     , SOAD_E_INV_ARG);
+
+    if (SoAd_Instance->config->groups[id]->automatic != FALSE) {
+        return E_NOT_OK;
+    }
 
+    for (index = SoAd_Instance->members.first[id]; index < SoAd_Instance->members.first[id + 1u]; ++index) {
+        SoAd_SoCon_Request(SoAd_Instance, SoAd_Instance->members.members[index], FALSE, abort);
     }
+    return E_OK;
 }
 
-Std_ReturnType SoAd_TcpAccepted(
-        TcpIp_SocketIdType          socket_id,
-        TcpIp_SocketIdType          socket_id_connected,
-        const TcpIp_SockAddrType*   remote
-    )
+/**
+ * @brief Assign a remote address to a connection
+ *
+ * A TCP connection can only change remote while closed. An open UDP
+ * connection follows its remote between listening and online.
+ */
+static Std_ReturnType SoAd_SoCon_AssignRemote(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, const TcpIp_SockAddrType* remote)
 {
-    SoAd_SoGrpIdType id_group;
-    Std_ReturnType   res;
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* group  = SoAd_Instance->config->groups[config->group];
+    SoAd_SoConStatusType*       status = &SoAd_Instance->connections[id];
+    SoAd_RemoteIdType           id_remote;
 
-    res = SoAd_SoGrp_Lookup(&id_group, socket_id);
-    if (res == E_OK) {
-        const SoAd_SoGrpConfigType* group  = SoAd_Config->groups[id_group];
-        SoAd_SoConIdType            id_connected;
-
-        if (group->initiate == FALSE) {
-            res = SoAd_SoCon_Lookup_FreeSocket(&id_connected, id_group, remote);
-            if (res == E_OK) {
-                SoAd_SoConStatusType* status_connected = &SoAd_SoConStatus[id_connected];
-                status_connected->socket_id = socket_id_connected;
-                SoAd_SockAddrCopy(&status_connected->remote, remote);
-                SoAd_SoCon_EnterState(id_connected, SOAD_SOCON_ONLINE);
-            }
-        }
+    if ((group->protocol == TCPIP_IPPROTO_TCP) && (status->state != SOAD_SOCON_OFFLINE)) {
+        return E_NOT_OK;
     }
 
-    return res;
-}
+    if (status->tx_route != NULL_PTR) {
+        return E_NOT_OK;
+    }
 
-void SoAd_TcpConnected(
-        TcpIp_SocketIdType          socket_id
-    )
-{
-    SoAd_SoConIdType id;
-    Std_ReturnType   res;
+    if (SoAd_Remote_Acquire(SoAd_Instance, remote, &id_remote) != E_OK) {
+        return E_NOT_OK;
+    }
 
-    res = SoAd_SoCon_Lookup(&id, socket_id);
-    if (res == E_OK) {
-        const SoAd_SoConConfigType* config = SoAd_Config->connections[id];
-        const SoAd_SoGrpConfigType* group  = SoAd_Config->groups[config->group];
-        SoAd_SoConStatusType*       status = &SoAd_SoConStatus[id];
+    SoAd_SoCon_SetRemote(SoAd_Instance, id, id_remote);
+    status->remote_release = FALSE;
 
-        if (group->initiate) {
-            if (status->state != SOAD_SOCON_ONLINE) {
-                if (group->protocol == TCPIP_IPPROTO_TCP) {
-                    SoAd_SoCon_EnterState(id, SOAD_SOCON_ONLINE);
-                }
-            }
+    if (group->protocol == TCPIP_IPPROTO_UDP) {
+        if ((status->state == SOAD_SOCON_RECONNECT) && (SoAd_Remote_Wildcard(SoAd_Instance, id_remote) == FALSE)) {
+            SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_ONLINE);
+        } else if ((status->state == SOAD_SOCON_ONLINE) && (SoAd_Remote_Wildcard(SoAd_Instance, id_remote) == TRUE)) {
+            SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_RECONNECT);
+        } else {
+            /* state unchanged */
         }
     }
+    return E_OK;
 }
 
-BufReq_ReturnType SoAd_CopyTxData(
-        TcpIp_SocketIdType          socket_id,
-        uint8*                      buf,
-        uint16                      len
+Std_ReturnType SoAd_SetRemoteAddr(
+        SoAd_SoConIdType            id,
+        const TcpIp_SockAddrType*   remote
     )
 {
-    Std_ReturnType       res;
-    BufReq_ReturnType    res_buf;
-    SoAd_SoConIdType     id_con;
-    res = SoAd_SoCon_Lookup(&id_con, socket_id);
-    if (res == E_OK) {
-        const SoAd_SoConConfigType* config = SoAd_Config->connections[id_con];
-        SoAd_SoConStatusType*       status = &SoAd_SoConStatus[id_con];
-        PduInfoType                 info;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_SETREMOTEADDR
+                     , SOAD_E_NOTINIT);
 
-        info.SduLength  = len;
-        info.SduDataPtr = buf;
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_SETREMOTEADDR
+                     , SOAD_E_INV_SOCKETID);
 
-        res_buf = status->tx_route->upper->copy_tx_data(status->tx_route->pdu_id
-                                                       , &info
-                                                       , NULL_PTR
-                                                       , &status->tx_available);
-        if (res_buf == BUFREQ_OK) {
-            status->tx_remain -= len;
-        }
-    } else {
-        res_buf = BUFREQ_E_NOT_OK;
-    }
+    SOAD_DET_CHECK_RET(remote != NULL_PTR
+                     , SOAD_API_SETREMOTEADDR
+                     , SOAD_E_PARAM_POINTER);
 
-    return res_buf;
+    return SoAd_SoCon_AssignRemote(SoAd_Instance, id, remote);
 }
 
-Std_ReturnType SoAd_IfTransmit(
-        PduIdType                   pdu_id,
-        const PduInfoType*          pdu_info
+Std_ReturnType SoAd_SetUniqueRemoteAddr(
+        SoAd_SoConIdType            id,
+        const TcpIp_SockAddrType*   remote,
+        SoAd_SoConIdType*           assigned
     )
 {
-    Std_ReturnType              res;
-    const SoAd_PduRouteType*    route;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoGrpIdType  id_grp;
+    SoAd_SoConIdType  id_con;
 
-    /**
-     * @req SWS_SoAd_00213
-     */
-    SOAD_DET_CHECK_RET(SoAd_Config != NULL_PTR
-                     , SOAD_API_IFTRANSMIT
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_SETUNIQUEREMOTEADDR
                      , SOAD_E_NOTINIT);
 
-    /**
-     * @req SWS_SoAd_00214
-     */
-    SOAD_DET_CHECK_RET(pdu_id < SOAD_CFG_PDUROUTE_COUNT
-                     , SOAD_API_IFTRANSMIT
-                     , SOAD_E_INV_PDUID);
-
-    /**
-     * @req SWS_SoAd_00653-TODO
-     */
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_SETUNIQUEREMOTEADDR
+                     , SOAD_E_INV_SOCKETID);
 
-    res = SoAd_GetPduRoute(pdu_id, &route);
+    SOAD_DET_CHECK_RET((remote != NULL_PTR) && (assigned != NULL_PTR)
+                     , SOAD_API_SETUNIQUEREMOTEADDR
+                     , SOAD_E_PARAM_POINTER);
 
-    if (res == E_OK) {
-        SoAd_SoConStatusType*       status;
-        const SoAd_SoConConfigType* config;
-        const SoAd_SoGrpConfigType* group;
-        Std_ReturnType              res;
+    if (SoAd_SockAddrWildcard(remote) == TRUE) {
+        return E_NOT_OK;
+    }
 
-        status = &SoAd_SoConStatus[route->destination.connection];
-        config = SoAd_Config->connections[route->destination.connection];
-        group  = SoAd_Config->groups[config->group];
+    /* a connection already talking to the remote is reused */
+    id_grp = SoAd_Instance->config->connections[id]->group;
+    id_con = SoAd_SoGrp_LookupRemote(SoAd_Instance, id_grp, SoAd_Remote_Lookup(SoAd_Instance, remote));
+    if (id_con != SOAD_SOCONID_INVALID) {
+        *assigned = id_con;
+        return E_OK;
+    }
 
-        if (status->state == SOAD_SOCON_ONLINE) {
-            switch(group->protocol) {
-                case TCPIP_IPPROTO_UDP:
-                    res = TcpIp_UdpTransmit(status->socket_id
-                                          , pdu_info->SduDataPtr
-                                          , &status->remote.base
-                                          , pdu_info->SduLength);
-                    break;
-                case TCPIP_IPPROTO_TCP:
-                    res = TcpIp_TcpTransmit(status->socket_id
-                                          , pdu_info->SduDataPtr
-                                          , pdu_info->SduLength
-                                          , TRUE);
-                    break;
-                default:
-                    res = E_NOT_OK;
-                    break;
+    /* otherwise the first free wildcard connection accepting it */
+    for (id_con = SoAd_Instance->groups[id_grp].free; id_con != SOAD_SOCONID_INVALID; id_con = SoAd_Instance->connections[id_con].remote_next) {
+        if (SoAd_SockAddrWildcardMatch(SoAd_Remote_Address(SoAd_Instance, SoAd_Instance->connections[id_con].remote), remote) == TRUE) {
+            if (SoAd_SoCon_AssignRemote(SoAd_Instance, id_con, remote) == E_OK) {
+                *assigned = id_con;
+                return E_OK;
             }
-        } else {
-            res = E_NOT_OK;
         }
     }
-    return res;
+    return E_NOT_OK;
 }
 
-
-Std_ReturnType SoAd_TpTransmit(
-        PduIdType                   pdu_id,
-        const PduInfoType*          pdu_info
+Std_ReturnType SoAd_GetRemoteAddr(
+        SoAd_SoConIdType            id,
+        TcpIp_SockAddrType*         remote
     )
 {
-    Std_ReturnType              res;
-    const SoAd_PduRouteType*    route;
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_RemoteIdType id_remote;
 
-    /**
-     * @req SWS_SoAd_00224
-     */
-    SOAD_DET_CHECK_RET(SoAd_Config != NULL_PTR
-                     , SOAD_API_TPTRANSMIT
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_GETREMOTEADDR
                      , SOAD_E_NOTINIT);
 
-    /**
-     * @req SWS_SoAd_00237
-     */
-    SOAD_DET_CHECK_RET(pdu_id < SOAD_CFG_PDUROUTE_COUNT
-                     , SOAD_API_TPTRANSMIT
-                     , SOAD_E_INV_PDUID);
+    SOAD_DET_CHECK_RET(id < SOAD_CFG_CONNECTION_COUNT
+                     , SOAD_API_GETREMOTEADDR
+                     , SOAD_E_INV_SOCKETID);
 
-    /**
-     * @req SWS_SoAd_00650-TODO
-     */
+    SOAD_DET_CHECK_RET(remote != NULL_PTR
+                     , SOAD_API_GETREMOTEADDR
+                     , SOAD_E_PARAM_POINTER);
+
+    /* caller buffer is sized by the domain it is prepared for */
+    id_remote = SoAd_Instance->connections[id].remote;
+    if ((id_remote == SOAD_REMOTEID_INVALID)
+    ||  (SoAd_Remote_Address(SoAd_Instance, id_remote)->domain != remote->domain)) {
+        return E_NOT_OK;
+    }
 
-    res = SoAd_GetPduRoute(pdu_id, &route);
+    SoAd_SockAddrCopy((TcpIp_SockAddrStorageType*)remote, SoAd_Remote_Address(SoAd_Instance, id_remote));
+    return E_OK;
+}
 
-    if (res == E_OK) {
-        SoAd_SoConStatusType* status;
-        status = &SoAd_SoConStatus[route->destination.connection];
-        status->tx_route = route;
+void SoAd_ReleaseRemoteAddr(
+        SoAd_SoConIdType            id
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_SoConStatusType* status;
+
+    SOAD_DET_CHECK_RET_0(SoAd_Instance->config != NULL_PTR
+                       , SOAD_API_RELEASEREMOTEADDR
+                       , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET_0(id < SOAD_CFG_CONNECTION_COUNT
+                       , SOAD_API_RELEASEREMOTEADDR
+                       , SOAD_E_INV_SOCKETID);
+
+    /* a connection in use keeps its remote until it is closed */
+    status = &SoAd_Instance->connections[id];
+    if ((status->state == SOAD_SOCON_ONLINE) || (status->tx_route != NULL_PTR)) {
+        status->remote_release = TRUE;
+    } else {
+        SoAd_Remote_Retain(SoAd_Instance, status->remote_config);
+        SoAd_SoCon_SetRemote(SoAd_Instance, id, status->remote_config);
     }
-    return res;
 }
 
 /**
- * @brief SWS_SoAd_00642-TODO
+ * @brief Close a connection on request
+ * @req   SWS_SoAd_00642
  */
-void SoAd_SoCon_ProcessClose(SoAd_SoConIdType id)
+static void SoAd_SoCon_ProcessClose(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    const SoAd_SoConConfigType* config = SoAd_Config->connections[id];
-    SoAd_SoConStatusType*       status       = &SoAd_SoConStatus[id];
+    const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[id];
+    SoAd_SoConStatusType*       status       = &SoAd_Instance->connections[id];
 
     if (status->request_close) {
+        const SoAd_SoGrpConfigType* group = SoAd_Instance->config->groups[config->group];
+
+        status->request_close = FALSE;
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+        SoAd_IfHeld_Clear(SoAd_Instance, id);
+#endif
         if (status->socket_id != TCPIP_SOCKETID_INVALID) {
-            TcpIp_Close(status->socket_id, status->request_abort);
+            /* a udp socket has no connection state, so it can stay bound */
+            if ((group->keep_socket != FALSE)
+            &&  (group->protocol == TCPIP_IPPROTO_UDP)
+            &&  (status->socket_spare == TCPIP_SOCKETID_INVALID)) {
+                status->socket_spare = status->socket_id;
+                SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_OFFLINE);
+            } else {
+                TcpIp_Close(status->socket_id, status->request_abort);
+            }
+        } else if (status->state != SOAD_SOCON_OFFLINE) {
+            /* group socket stays bound for the next open of any member */
+            SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_OFFLINE);
+        } else {
+            /* already closed */
         }
-        status->request_close = FALSE;
+        status->request_abort = FALSE;
     }
 }
 
-void SoAd_SoCon_ProcessTransmit(SoAd_SoConIdType id)
+void SoAd_SoCon_ProcessTransmit(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
     SoAd_SoConStatusType*       status;
     const SoAd_SoConConfigType* config;
@@ -776,89 +4047,221 @@ void SoAd_SoCon_ProcessTransmit(SoAd_SoConIdType id)
     Std_ReturnType              res;
     BufReq_ReturnType           res_buf;
     PduInfoType                 pdu_info;
-
-    status = &SoAd_SoConStatus[id];
-    config = SoAd_Config->connections[id];
-    group  = SoAd_Config->groups[config->group];
+    PduLengthType               available;
+    uint32                      length;
+    uint32                      room;
+    boolean                     done;
+
+    status = &SoAd_Instance->connections[id];
+    config = SoAd_Instance->config->connections[id];
+    group  = SoAd_Instance->config->groups[config->group];
     route  = status->tx_route;
 
-    if (route) {
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    SoAd_IfHeld_Process(SoAd_Instance, id);
+#endif
+
+    if (route
+    &&  (SoAd_TxShape_Ready(SoAd_Instance, id) == TRUE)
+    &&  (SOAD_INFLIGHT_ROOM(id, NULL_PTR) == TRUE)) {
         pdu_info.SduDataPtr = NULL_PTR;
         pdu_info.SduLength  = 0u;
 
         if (status->tx_available == 0u) {
-            res_buf = route->upper->copy_tx_data(route->pdu_id, &pdu_info, NULL_PTR, &status->tx_available);
+            available = 0u;
+            res_buf   = route->upper->copy_tx_data(route->pdu_id, &pdu_info, NULL_PTR, &available);
+            status->tx_available = available;
+            if ((status->tx_stream == FALSE) && (status->tx_available > status->tx_remain)) {
+                status->tx_available = status->tx_remain;
+            }
+            if ((res_buf == BUFREQ_OK) && (status->tx_available != 0u) && (group->tp_tx_timeout != 0u)) {
+                SoAd_Timer_Arm(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_TPTX), group->tp_tx_timeout);
+            }
         } else {
             res_buf = BUFREQ_OK;
         }
 
-        if (res_buf == BUFREQ_OK) {
+        length = status->tx_available;
+        done   = FALSE;
+
+        if ((res_buf == BUFREQ_OK) && (length == 0u)) {
+            /* a stream ends once the upper layer has nothing more */
+            res  = E_OK;
+            done = status->tx_stream;
+        } else if ((res_buf == BUFREQ_OK)
+               &&  (group->protocol == TCPIP_IPPROTO_UDP)
+               &&  (length < status->tx_remain)) {
+            /* a datagram goes out whole, ask again next time */
+            status->tx_available = 0u;
+            res = E_OK;
+        } else if (res_buf == BUFREQ_OK) {
+            /* TcpIp pulls the data through SoAd_CopyTxData, header first */
+            length     += status->tx_header_left;
+            if (group->protocol == TCPIP_IPPROTO_TCP) {
+                /* a stream goes in chunks within the shaping budget, the rest next time */
+                room   = SoAd_TxShape_Room(SoAd_Instance, id);
+                length = (length < room) ? length : room;
+            }
+            SoAd_Instance->tx_copy   = id;
+            SoAd_Instance->tx_copied = 0u;
             switch(group->protocol) {
                 case TCPIP_IPPROTO_UDP:
-                    res = TcpIp_UdpTransmit(status->socket_id
+                    res = TcpIp_UdpTransmit(SoAd_SoCon_Socket(SoAd_Instance, id)
                                           , NULL_PTR
-                                          , &status->remote.base
-                                          , status->tx_available);
+                                          , SoAd_Remote_Address(SoAd_Instance, status->remote)
+                                          , (uint16)length);
                     break;
                 case TCPIP_IPPROTO_TCP:
                     res = TcpIp_TcpTransmit(status->socket_id
                                           , NULL_PTR
-                                          , status->tx_available
+                                          , length
                                           , FALSE);
                     break;
                 default:
                     res = E_NOT_OK;
                     break;
             }
+            SoAd_Instance->tx_copy = SOAD_SOCONID_INVALID;
+
+            if (res == E_OK) {
+                /* without forced retrieval TcpIp may take less than offered */
+                SoAd_TxShape_Charge(SoAd_Instance, id, SoAd_Instance->tx_copied);
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+                if (SoAd_Instance->tx_copied != 0u) {
+                    SoAd_InFlight_Push(SoAd_Instance, id, NULL_PTR, SoAd_Instance->tx_copied);
+                }
+#endif
+                done = (status->tx_stream == FALSE) && (status->tx_remain == 0u) && (status->tx_header_left == 0u);
+            }
         } else if (res_buf == BUFREQ_E_BUSY) {
             res = E_OK;
         } else {
             res = E_NOT_OK;
         }
 
-        if (status->tx_remain == 0u || (res != E_OK)) {
+        if ((done == TRUE) || (res != E_OK)) {
             /** TODO - SoAdSocketTcpImmediateTpTxConfirmation==FALSE */
             status->tx_route     = NULL_PTR;
             status->tx_remain    = 0u;
             status->tx_available = 0u;
+            status->tx_header_left = 0u;
+            SoAd_Timer_Cancel(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_TPTX));
             route->upper->tx_confirmation(route->pdu_id, res);
         }
     }
 }
 
-void SoAd_SoCon_State_Online(SoAd_SoConIdType id)
+/**
+ * @brief Retrieve a socket from TcpIp and bind it to the group's local address
+ */
+static Std_ReturnType SoAd_SoCon_Allocate(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, TcpIp_SocketIdType* socket_id)
+{
+    const SoAd_SoConConfigType* config       = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* config_group = SoAd_Instance->config->groups[config->group];
+    Std_ReturnType              res;
+    TcpIp_SocketIdType          retrieved = TCPIP_SOCKETID_INVALID;
+
+    res = TcpIp_SoAdGetSocket(config_group->domain
+                            , config_group->protocol
+                            , &retrieved);
+    if (res == E_OK) {
+        uint16 localport = config_group->localport;
+        res = TcpIp_Bind(retrieved
+                       , config_group->localaddr
+                       , &localport);
+
+        if (res != E_OK) {
+            TcpIp_Close(retrieved, TRUE);
+            retrieved = TCPIP_SOCKETID_INVALID;
+        }
+    }
+    *socket_id = (res == E_OK) ? retrieved : TCPIP_SOCKETID_INVALID;
+    return res;
+}
+
+/**
+ * @brief Keep a bound socket ready, so a TCP client reconnect is a single connect
+ */
+static void SoAd_SoCon_PrepareSpare(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    const SoAd_SoConConfigType* config       = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* config_group = SoAd_Instance->config->groups[config->group];
+    SoAd_SoConStatusType*       status       = &SoAd_Instance->connections[id];
+
+    if ((config_group->keep_socket != FALSE)
+    &&  (config_group->initiate    != FALSE)
+    &&  (config_group->protocol    == TCPIP_IPPROTO_TCP)
+    &&  (status->socket_spare      == TCPIP_SOCKETID_INVALID)
+    &&  (status->spare_failed      == FALSE)
+    &&  (status->addr_waiting      == FALSE)) {
+        if (SoAd_SoCon_Allocate(SoAd_Instance, id, &status->socket_spare) != E_OK) {
+            status->spare_failed = TRUE;
+        }
+    }
+}
+
+void SoAd_SoCon_State_Online(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    SoAd_SoCon_ProcessClose(id);
-    SoAd_SoCon_ProcessTransmit(id);
+    SoAd_SoCon_PrepareSpare(SoAd_Instance, id);
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    (void)SoAd_SoCon_ProcessReceive(SoAd_Instance, id);
+#endif
 }
 
-void SoAd_SoCon_State_Reconnect(SoAd_SoConIdType id)
+void SoAd_SoCon_State_Reconnect(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    SoAd_SoCon_ProcessClose(id);
+    /* waiting on TcpIp, requests are handled by SoAd_Request_MainFunction */
 }
 
 /**
  * Check if we perform an open on the socket
  * @req  SWS_SoAd_00589
- * @todo TCPIP_IPADDR_STATE_ASSIGNED
  * @todo Only first socket of a tcp group should be opened
  */
-static Std_ReturnType SoAd_SoCon_CheckOpen(SoAd_SoConIdType id)
+static Std_ReturnType SoAd_SoCon_CheckOpen(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    const SoAd_SoConConfigType* config       = SoAd_Config->connections[id];
-    const SoAd_SoGrpConfigType* config_group = SoAd_Config->groups[config->group];
-    SoAd_SoConStatusType*       status       = &SoAd_SoConStatus[id];
-    SoAd_SoGrpStatusType*       status_group = &SoAd_SoGrpStatus[config->group];
+    const SoAd_SoConConfigType* config       = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* config_group = SoAd_Instance->config->groups[config->group];
+    SoAd_SoConStatusType*       status       = &SoAd_Instance->connections[id];
+    SoAd_SoGrpStatusType*       status_group = &SoAd_Instance->groups[config->group];
     Std_ReturnType              res = E_NOT_OK;
 
+    if (status->addr_waiting) {
+        return E_NOT_OK;
+    }
+
+#if(SOAD_CFG_LOCALADDR_COUNT > 0u)
+    /* queue up until the local address is there, rather than fail each cycle */
+    if (config_group->localaddr < SOAD_CFG_LOCALADDR_COUNT) {
+        SoAd_LocalAddrStatusType* status_addr = &SoAd_Instance->localaddrs[config_group->localaddr];
+        if (status_addr->state != TCPIP_IPADDR_STATE_ASSIGNED) {
+            status->addr_waiting = TRUE;
+            status->addr_next    = status_addr->waiting;
+            status_addr->waiting = id;
+            return E_NOT_OK;
+        }
+    }
+#endif
+
     if (status->socket_id == TCPIP_SOCKETID_INVALID) {
         if ((config_group->automatic != FALSE) || (status->request_open != FALSE)) {
-            if (status->remote.base.domain != (TcpIp_DomainType)0u) {
+            if (status->remote != SOAD_REMOTEID_INVALID) {
                 res = E_OK;
             }
         }
     }
 
+    /* hold off while a previous failure is backing off */
+    if (res == E_OK) {
+        if (SoAd_Timer_Active(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_RETRY))) {
+            res = E_NOT_OK;
+        } else if ((config_group->initiate == FALSE)
+               &&  (status_group->socket_id == TCPIP_SOCKETID_INVALID)
+               &&  SoAd_Timer_Active(SoAd_Instance, SOAD_TIMER_GRP_ID(config->group, SOAD_TIMER_GRP_RETRY))) {
+            res = E_NOT_OK;
+        }
+    }
+
     return res;
 }
 
@@ -870,75 +4273,93 @@ static Std_ReturnType SoAd_SoCon_CheckOpen(SoAd_SoConIdType id)
  * @todo  SWS_SoAd_00689 Socket parameters
  * @todo  MaxChannels of socket group
  */
-static Std_ReturnType SoAd_SoCon_PerformOpen(SoAd_SoConIdType id)
+static Std_ReturnType SoAd_SoCon_PerformOpen(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    const SoAd_SoConConfigType* config       = SoAd_Config->connections[id];
-    const SoAd_SoGrpConfigType* config_group = SoAd_Config->groups[config->group];
-    SoAd_SoConStatusType*       status       = &SoAd_SoConStatus[id];
-    SoAd_SoGrpStatusType*       status_group = &SoAd_SoGrpStatus[config->group];
+    const SoAd_SoConConfigType* config       = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* config_group = SoAd_Instance->config->groups[config->group];
+    SoAd_SoConStatusType*       status       = &SoAd_Instance->connections[id];
+    SoAd_SoGrpStatusType*       status_group = &SoAd_Instance->groups[config->group];
     Std_ReturnType              res;
-    TcpIp_SocketIdType         *socket_id;
-
-    status->request_open = FALSE;
+    TcpIp_SocketIdType         *target;
+    TcpIp_SocketIdType          socket_id;
 
     /*
      * for initiating sockets, the connection itself needs a socket
      * for waiting sockets, it's the socket group that holds the socket
      */
     if (config_group->initiate) {
-        socket_id = &status->socket_id;
+        target = &status->socket_id;
     } else {
-        socket_id = &status_group->socket_id;
+        target = &status_group->socket_id;
     }
 
-    if (*socket_id == TCPIP_SOCKETID_INVALID) {
-        res = TcpIp_SoAdGetSocket(config_group->domain
-                                , config_group->protocol
-                                , socket_id);
+    if (*target == TCPIP_SOCKETID_INVALID) {
+        status->spare_failed = FALSE;
+
+        if (config_group->initiate && (status->socket_spare != TCPIP_SOCKETID_INVALID)) {
+            socket_id            = status->socket_spare;
+            status->socket_spare = TCPIP_SOCKETID_INVALID;
+            res = E_OK;
+        } else {
+            res = SoAd_SoCon_Allocate(SoAd_Instance, id, &socket_id);
+        }
+
         if (res == E_OK) {
-            uint16 localport = config_group->localport;
-            res = TcpIp_Bind(*socket_id
-                           , config_group->localaddr
-                           , &localport);
+            /* transmitters read the socket unlocked, publish it whole */
+            SOAD_CFG_ATOMIC_STORE(target, socket_id);
 
-            if (res == E_OK) {
-                if (config_group->protocol == TCPIP_IPPROTO_TCP) {
-                    if (config_group->initiate) {
-                        res = TcpIp_TcpConnect(*socket_id
-                                             , &status->remote.base);
-                    } else {
-                        res = TcpIp_TcpListen(*socket_id
-                                             , SOAD_CFG_CONNECTION_COUNT);
-                    }
+            if (config_group->protocol == TCPIP_IPPROTO_TCP) {
+                if (config_group->initiate) {
+                    res = TcpIp_TcpConnect(socket_id
+                                         , SoAd_Remote_Address(SoAd_Instance, status->remote));
+                } else {
+                    res = TcpIp_TcpListen(socket_id
+                                         , SOAD_CFG_CONNECTION_COUNT);
                 }
             }
 
             /* on failure, we must clean up the socket so will try again */
             if (res != E_OK) {
-                TcpIp_Close(*socket_id, TRUE);
-                *socket_id = TCPIP_SOCKETID_INVALID;
+                SOAD_CFG_ATOMIC_STORE(target, TCPIP_SOCKETID_INVALID);
+                TcpIp_Close(socket_id, TRUE);
+            }
+        }
+
+        if (res != E_OK) {
+            if (config_group->initiate) {
+                SoAd_Retry_Arm(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_RETRY), &config_group->retry, &status->retry_delay);
+            } else {
+                SoAd_Retry_Arm(SoAd_Instance, SOAD_TIMER_GRP_ID(config->group, SOAD_TIMER_GRP_RETRY), &config_group->retry, &status_group->retry_delay);
             }
+        } else if (config_group->initiate == FALSE) {
+            status_group->retry_delay = 0u;
+        } else if (config_group->protocol != TCPIP_IPPROTO_TCP) {
+            status->retry_delay = 0u;
         }
     } else {
         res = E_OK;
     }
 
+    /* a failed manual open is retried like an automatic one */
+    if (res == E_OK) {
+        status->request_open = FALSE;
+    }
     return res;
 }
 
-void SoAd_SoCon_State_Offline(SoAd_SoConIdType id)
+void SoAd_SoCon_State_Offline(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    const SoAd_SoConConfigType* config       = SoAd_Config->connections[id];
-    const SoAd_SoGrpConfigType* config_group = SoAd_Config->groups[config->group];
-    SoAd_SoConStatusType*       status       = &SoAd_SoConStatus[id];
+    const SoAd_SoConConfigType* config       = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* config_group = SoAd_Instance->config->groups[config->group];
+    SoAd_SoConStatusType*       status       = &SoAd_Instance->connections[id];
     Std_ReturnType res;
 
-    res = SoAd_SoCon_CheckOpen(id);
+    res = SoAd_SoCon_CheckOpen(SoAd_Instance, id);
     if (res == E_OK) {
-        res = SoAd_SoCon_PerformOpen(id);
+        res = SoAd_SoCon_PerformOpen(SoAd_Instance, id);
         if (res == E_OK) {
             if (config_group->protocol == TCPIP_IPPROTO_TCP) {
-                SoAd_SoCon_EnterState(id, SOAD_SOCON_RECONNECT);
+                SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_RECONNECT);
             } else if (config_group->protocol == TCPIP_IPPROTO_UDP) {
 
                 /**
@@ -949,27 +4370,60 @@ void SoAd_SoCon_State_Offline(SoAd_SoConIdType id)
                  * it seems redundant based on the wildcard check
                  */
 
-                if (SoAd_SockAddrWildcard(&status->remote.base) == TRUE) {
-                    SoAd_SoCon_EnterState(id, SOAD_SOCON_RECONNECT);
+                if (SoAd_Remote_Wildcard(SoAd_Instance, status->remote) == TRUE) {
+                    SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_RECONNECT);
                 } else {
-                    SoAd_SoCon_EnterState(id, SOAD_SOCON_ONLINE);
+                    SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_ONLINE);
                 }
             }
         }
+    } else {
+        /* use the wait, so the eventual open is cheaper */
+        SoAd_SoCon_PrepareSpare(SoAd_Instance, id);
     }
 }
 
-static void SoAd_SoCon_EnterState(SoAd_SoConIdType id, SoAd_SoConStateType state)
+static void SoAd_SoCon_EnterState(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id, SoAd_SoConStateType state)
 {
-    const SoAd_SoConConfigType* con_config = SoAd_Config->connections[id];
-    const SoAd_SoGrpConfigType* grp_config = SoAd_Config->groups[con_config->group];
-    SoAd_SoConStatusType*       con_status = &SoAd_SoConStatus[id];
+    const SoAd_SoConConfigType* con_config = SoAd_Instance->config->connections[id];
+    const SoAd_SoGrpConfigType* grp_config = SoAd_Instance->config->groups[con_config->group];
+    SoAd_SoConStatusType*       con_status = &SoAd_Instance->connections[id];
     SoAd_SocketRouteIdType      route_id;
 
+    /* supervision timers only run for an online connection */
+    if (state != SOAD_SOCON_ONLINE) {
+        SoAd_Timer_Cancel(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_ALIVE));
+        SoAd_Timer_Cancel(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_TPTX));
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+        /* nothing in flight will be confirmed anymore */
+        SoAd_Instance->inflight[id].count = 0u;
+#endif
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+        /* retried PDUs wait for the connection to come back */
+        if (con_config->if_retry == 0u) {
+            SoAd_IfHeld_Clear(SoAd_Instance, id);
+        }
+#endif
+    }
+
     /* update connection state */
     switch(state) {
         case SOAD_SOCON_OFFLINE:
-            con_status->socket_id = TCPIP_SOCKETID_INVALID;
+            SOAD_CFG_ATOMIC_STORE(&con_status->socket_id, TCPIP_SOCKETID_INVALID);
+            con_status->rx_unacked = 0u;
+
+            if (con_status->remote_release) {
+                con_status->remote_release = FALSE;
+                SoAd_Remote_Retain(SoAd_Instance, con_status->remote_config);
+                SoAd_SoCon_SetRemote(SoAd_Instance, id, con_status->remote_config);
+            }
+
+            /* a connect attempt that failed is retried with backoff */
+            if ((con_status->state == SOAD_SOCON_RECONNECT)
+            &&  (grp_config->initiate != FALSE)
+            &&  (grp_config->protocol == TCPIP_IPPROTO_TCP)) {
+                SoAd_Retry_Arm(SoAd_Instance, SOAD_TIMER_ID(id, SOAD_TIMER_RETRY), &grp_config->retry, &con_status->retry_delay);
+            }
 
             if (con_status->rx_route) {
                 con_status->rx_route->destination.upper->rx_indication(
@@ -978,15 +4432,23 @@ static void SoAd_SoCon_EnterState(SoAd_SoConIdType id, SoAd_SoConStateType state
                 con_status->rx_route = NULL;
             }
 
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+            if (con_status->rx_buffer != SOAD_BUFFERID_INVALID) {
+                SoAd_Buffer_Free(SoAd_Instance, con_status->rx_buffer);
+                con_status->rx_buffer = SOAD_BUFFERID_INVALID;
+            }
+#endif
+
             break;
 
         case SOAD_SOCON_RECONNECT:
             break;
 
         case SOAD_SOCON_ONLINE: {
+            con_status->retry_delay = 0u;
 
-            if (SoAd_GetSocketRoute(id, SOAD_PDUHEADERID_INVALID, &route_id) == E_OK) {
-                const SoAd_SocketRouteType* route_config = SoAd_Config->socket_routes[route_id];
+            if (SoAd_GetSocketRoute(SoAd_Instance, id, SOAD_PDUHEADERID_INVALID, &route_id) == E_OK) {
+                const SoAd_SocketRouteType* route_config = SoAd_Instance->config->socket_routes[route_id];
                 PduLengthType               len  = 0u;
                 PduInfoType                 info = {0u};
 
@@ -1007,32 +4469,570 @@ static void SoAd_SoCon_EnterState(SoAd_SoConIdType id, SoAd_SoConStateType state
             break;
     }
 
-    con_status->state = state;
+    if (con_status->state != state) {
+        SOAD_MEAS_INC(connections[id].state_changes, 1u);
+        SOAD_TRACE_STATECHANGE(id, state);
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+        if (grp_config->mode_chg != 0u) {
+            SoAd_SoConList_Push(&SoAd_Instance->modechg_list, id);
+        }
+#endif
+    }
+    SOAD_CFG_ATOMIC_STORE(&con_status->state, state);
+
+    /* transmission requested before the connection came up */
+    SoAd_TxSchedule_Push(SoAd_Instance, id);
+}
+
+/**
+ * @brief Revert a remote learned from a wildcard when nothing was received from it
+ * @req   SWS_SoAd_00695
+ */
+static void SoAd_SoCon_AliveTimeout(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+
+    if (status->state == SOAD_SOCON_ONLINE) {
+        SoAd_Remote_Retain(SoAd_Instance, status->remote_config);
+        SoAd_SoCon_SetRemote(SoAd_Instance, id, status->remote_config);
+        SoAd_SoCon_EnterState(SoAd_Instance, id, SOAD_SOCON_RECONNECT);
+    }
+}
+
+/**
+ * @brief Abort a TP transmission the upper layer stopped feeding
+ */
+static void SoAd_SoCon_TpTxTimeout(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    SoAd_SoConStatusType*    status = &SoAd_Instance->connections[id];
+    const SoAd_PduRouteType* route  = status->tx_route;
+
+    if (route) {
+        status->tx_route     = NULL_PTR;
+        status->tx_remain    = 0u;
+        status->tx_available = 0u;
+        status->tx_header_left = 0u;
+        route->upper->tx_confirmation(route->pdu_id, E_NOT_OK);
+    }
+}
+
+/**
+ * @brief Dispatch an expired timer
+ *
+ * Retry timers need no action, an armed retry timer just holds off
+ * the open in SoAd_SoCon_CheckOpen.
+ */
+static void SoAd_Timer_Expired(SoAd_InstanceType* SoAd_Instance, SoAd_TimerIdType id)
+{
+    SoAd_SoConIdType id_con = (SoAd_SoConIdType)(id / SOAD_TIMER_SOCON_COUNT);
+
+    if (id >= SOAD_TIMER_SOCON_TOTAL) {
+        return;
+    }
+
+    switch (id % SOAD_TIMER_SOCON_COUNT) {
+        case SOAD_TIMER_ALIVE:
+            SoAd_SoCon_AliveTimeout(SoAd_Instance, id_con);
+            break;
+        case SOAD_TIMER_TPTX:
+            SoAd_SoCon_TpTxTimeout(SoAd_Instance, id_con);
+            break;
+        default:
+            break;
+    }
 }
 
-void SoAd_SoCon_MainFunction(SoAd_SoConIdType id)
+void SoAd_SoCon_MainFunction(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
 {
-    SoAd_SoConStatusType* status = &SoAd_SoConStatus[id];
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
 
     switch(status->state) {
         case SOAD_SOCON_OFFLINE:
-            SoAd_SoCon_State_Offline(id);
+            /* manual opens are driven by the request queue */
+            if (SoAd_Instance->config->groups[SoAd_Instance->config->connections[id]->group]->automatic != FALSE) {
+                SoAd_SoCon_State_Offline(SoAd_Instance, id);
+            }
             break;
         case SOAD_SOCON_RECONNECT:
-            SoAd_SoCon_State_Reconnect(id);
+            SoAd_SoCon_State_Reconnect(SoAd_Instance, id);
             break;
         case SOAD_SOCON_ONLINE:
-            SoAd_SoCon_State_Online(id);
+            SoAd_SoCon_State_Online(SoAd_Instance, id);
             break;
         default:
             break;
     }
 }
 
+/**
+ * @brief Act on open and close requests of a connection
+ */
+static void SoAd_SoCon_ProcessRequest(SoAd_InstanceType* SoAd_Instance, SoAd_SoConIdType id)
+{
+    SoAd_SoConStatusType* status = &SoAd_Instance->connections[id];
+
+    SoAd_SoCon_ProcessClose(SoAd_Instance, id);
+
+    if (status->request_open) {
+        if (status->state == SOAD_SOCON_OFFLINE) {
+            SoAd_SoCon_State_Offline(SoAd_Instance, id);
+        } else {
+            status->request_open = FALSE;
+        }
+    }
+}
+
+/**
+ * @brief Check if the main function has used up its budget
+ *
+ * Open and close requests and connections handled count as one unit
+ * each. At least one unit is always done, so a too tight budget still
+ * makes progress.
+ */
+static boolean SoAd_MainFunction_Exhausted(SoAd_InstanceType* SoAd_Instance, uint16 units, uint32 start)
+{
+    boolean res = FALSE;
+
+    if (units != 0u) {
+        if ((SoAd_Instance->config->main_budget != 0u)
+        &&  (units >= SoAd_Instance->config->main_budget)) {
+            res = TRUE;
+        }
+
+        if ((SoAd_Instance->config->main_cycles != 0u)
+        &&  ((uint32)(SOAD_CFG_TRACE_TIMESTAMP() - start) >= SoAd_Instance->config->main_cycles)) {
+            res = TRUE;
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Act on queued requests within the main function budget
+ * @return units used
+ *
+ * Oldest first, so requests left for a later cycle are not starved
+ * by newer ones. An open that could not be done yet goes back to the
+ * end of the queue, so only connections with requests are visited.
+ */
+static uint16 SoAd_Request_MainFunction(SoAd_InstanceType* SoAd_Instance, uint32 start)
+{
+    SoAd_SoConIdType pending = SoAd_Instance->requests.count;
+    SoAd_SoConIdType id;
+    uint16           units   = 0u;
+
+    for (; pending > 0u; --pending) {
+        if (SoAd_MainFunction_Exhausted(SoAd_Instance, units, start)) {
+            break;
+        }
+
+        (void)SoAd_SoConList_PopOldest(&SoAd_Instance->requests, &id);
+        SoAd_SoCon_ProcessRequest(SoAd_Instance, id);
+        if (SoAd_Instance->connections[id].request_open) {
+            SoAd_SoConList_Push(&SoAd_Instance->requests, id);
+        }
+        units++;
+    }
+    return units;
+}
+
+/**
+ * @brief Serve pending transmissions by strict priority
+ */
+static void SoAd_TxSchedule_MainFunction(SoAd_InstanceType* SoAd_Instance)
+{
+    uint16 units = 0u;
+    uint8  prio;
+
+    for (prio = 0u; prio < SOAD_CFG_TX_PRIORITY_COUNT; ++prio) {
+        SoAd_TxQueueType* queue   = &SoAd_Instance->tx_schedule.classes[prio];
+        SoAd_SoConIdType  pending = queue->count;
+
+        for (; pending > 0u; --pending) {
+            SoAd_SoConIdType id;
+
+            if ((SoAd_Instance->config->tx_budget != 0u) && (units >= SoAd_Instance->config->tx_budget)) {
+                return;
+            }
+
+            id = SoAd_TxSchedule_Pop(SoAd_Instance, queue);
+            /* over budget connections keep their place for a later cycle */
+            if ((SoAd_Instance->connections[id].state == SOAD_SOCON_ONLINE)
+            &&  (SoAd_TxShape_Ready(SoAd_Instance, id) == TRUE)) {
+                SoAd_SoCon_ProcessTransmit(SoAd_Instance, id);
+                units++;
+            }
+
+            /* unfinished work goes behind its class for the next cycle */
+            SoAd_TxSchedule_Push(SoAd_Instance, id);
+        }
+    }
+}
+
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+/**
+ * @brief Report mode changes of the cycle, one call per upper layer
+ */
+static void SoAd_ModeChg_MainFunction(SoAd_InstanceType* SoAd_Instance)
+{
+    SoAd_SoConIdType index;
+    SoAd_SoConIdType count = SoAd_Instance->modechg_list.count;
+    uint8            upper;
+
+    if (count == 0u) {
+        return;
+    }
+
+    for (index = 0u; index < count; ++index) {
+        SoAd_SoConIdType id = SoAd_Instance->modechg_list.items[index];
+        SoAd_Instance->modechg_events[index].connection = id;
+        SoAd_Instance->modechg_events[index].mode       = SoAd_Instance->connections[id].state;
+        SoAd_Instance->modechg_list.member[id]          = FALSE;
+    }
+    SoAd_Instance->modechg_list.count = 0u;
+
+    /* callbacks may change modes again, those are reported next cycle */
+    for (upper = 0u; upper < SOAD_CFG_MODECHG_COUNT; ++upper) {
+        const SoAd_SoConModeChgType* notify = SoAd_Instance->config->mode_chg[upper];
+        const uint32                 mask   = (uint32)1u << upper;
+        uint16                       used   = 0u;
+
+        if ((notify == NULL_PTR) || (notify->mode_chg == NULL_PTR)) {
+            continue;
+        }
+
+        for (index = 0u; index < count; ++index) {
+            const SoAd_SoConConfigType* config = SoAd_Instance->config->connections[SoAd_Instance->modechg_events[index].connection];
+            if ((SoAd_Instance->config->groups[config->group]->mode_chg & mask) != 0u) {
+                SoAd_Instance->modechg_upper[used++] = SoAd_Instance->modechg_events[index];
+            }
+        }
+
+        if (used > 0u) {
+            notify->mode_chg(SoAd_Instance->modechg_upper, used);
+        }
+    }
+}
+#endif
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+static void SoAd_MainFunction_Measure(SoAd_InstanceType* SoAd_Instance, uint32 start, boolean exhausted)
+{
+    SoAd_MainFunctionTimingType* timing  = &SoAd_Instance->mainfunction_timing;
+    uint32                       elapsed = SOAD_CFG_TRACE_TIMESTAMP() - start;
+
+    if ((timing->calls == 0u) || (elapsed < timing->min)) {
+        timing->min = elapsed;
+    }
+    if (elapsed > timing->max) {
+        timing->max = elapsed;
+    }
+    timing->total += elapsed;
+    timing->calls++;
+    if (exhausted) {
+        timing->exhausted++;
+    }
+}
+#endif
+
 void SoAd_MainFunction(void)
 {
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
     SoAd_SoConIdType id;
-    for (id = 0u; id < SOAD_CFG_CONNECTION_COUNT; ++id) {
-        SoAd_SoCon_MainFunction(id);
+    uint16           units;
+    uint16           visited;
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    boolean          exhausted = FALSE;
+#endif
+    uint32           start     = SOAD_CFG_TRACE_TIMESTAMP();
+
+    SOAD_TRACE_ENTER(SOAD_TRACE_MAINFUNCTION);
+
+    SoAd_Timer_Tick(SoAd_Instance);
+
+    units = SoAd_Request_MainFunction(SoAd_Instance, start);
+
+    SoAd_TxSchedule_MainFunction(SoAd_Instance);
+
+    /* round robin from where the previous call stopped */
+    id = SoAd_Instance->mainfunction_cursor;
+    for (visited = 0u; visited < SOAD_CFG_CONNECTION_COUNT; ++visited, ++units) {
+        if (SoAd_MainFunction_Exhausted(SoAd_Instance, units, start)) {
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+            exhausted = TRUE;
+#endif
+            break;
+        }
+
+        SoAd_SoCon_MainFunction(SoAd_Instance, id);
+
+        if (++id == SOAD_CFG_CONNECTION_COUNT) {
+            id = 0u;
+        }
+    }
+    SoAd_Instance->mainfunction_cursor = id;
+
+    SoAd_RxWindow_MainFunction(SoAd_Instance);
+
+#if(SOAD_CFG_TX_INFLIGHT_SIZE > 0u)
+    SoAd_InFlight_MainFunction(SoAd_Instance);
+#else
+    SoAd_IfConfirm_MainFunction(SoAd_Instance);
+#endif
+
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+    SoAd_ModeChg_MainFunction(SoAd_Instance);
+#endif
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+    SoAd_MainFunction_Measure(SoAd_Instance, start, exhausted);
+#endif
+
+    SOAD_TRACE_EXIT(SOAD_TRACE_MAINFUNCTION, SOAD_SOCONID_INVALID, SOAD_TRACE_ROUTE_NONE, 0u, E_OK);
+}
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+/**
+ * @brief Read and optionally reset a measurement counter
+ *
+ * Counters of all cores are summed. A reset is not atomic against
+ * concurrent increments on other cores, so a few counts can be lost.
+ *
+ * @param[in]  idx   SOAD_MEAS_DROP_TCP, SOAD_MEAS_DROP_UDP, or SOAD_MEAS_ALL to reset all
+ * @param[in]  reset reset the counter after reading
+ * @param[out] data  counter value, may be NULL_PTR to only reset
+ */
+Std_ReturnType SoAd_GetAndResetMeasurementData(
+        SoAd_MeasurementIdxType     idx,
+        boolean                     reset,
+        uint32*                     data
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    uint32 value = 0u;
+    uint8  core;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_GETANDRESETMEASUREMENTDATA
+                     , SOAD_E_NOTINIT);
+
+    switch (idx) {
+        case SOAD_MEAS_DROP_TCP:
+            for (core = 0u; core < SOAD_CFG_MEASUREMENT_CORE_COUNT; ++core) {
+                value += SoAd_Instance->measurement[core].drop_tcp;
+                if (reset) {
+                    SoAd_Instance->measurement[core].drop_tcp = 0u;
+                }
+            }
+            break;
+
+        case SOAD_MEAS_DROP_UDP:
+            for (core = 0u; core < SOAD_CFG_MEASUREMENT_CORE_COUNT; ++core) {
+                value += SoAd_Instance->measurement[core].drop_udp;
+                if (reset) {
+                    SoAd_Instance->measurement[core].drop_udp = 0u;
+                }
+            }
+            break;
+
+        case SOAD_MEAS_ALL:
+            if (reset) {
+                memset(SoAd_Instance->measurement, 0, sizeof(SoAd_Instance->measurement));
+            }
+            break;
+
+        default:
+            SOAD_DET_ERROR(SOAD_API_GETANDRESETMEASUREMENTDATA
+                         , SOAD_E_INV_ARG);
+            return E_NOT_OK;
     }
+
+    if (data != NULL_PTR) {
+        *data = value;
+    }
+    return E_OK;
+}
+
+/**
+ * @brief Read execution time statistics of SoAd_MainFunction
+ *
+ * Compare max against the time reserved for the main function in
+ * the timing analysis; exhausted counts calls that deferred work.
+ */
+Std_ReturnType SoAd_GetMainFunctionStats(
+        SoAd_MainFunctionStatsType* stats,
+        boolean                     reset
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    const SoAd_MainFunctionTimingType* timing = &SoAd_Instance->mainfunction_timing;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_GETMAINFUNCTIONSTATS
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(stats != NULL_PTR
+                     , SOAD_API_GETMAINFUNCTIONSTATS
+                     , SOAD_E_PARAM_POINTER);
+
+    stats->calls     = timing->calls;
+    stats->min       = timing->min;
+    stats->max       = timing->max;
+    stats->avg       = (timing->calls != 0u) ? (timing->total / timing->calls) : 0u;
+    stats->exhausted = timing->exhausted;
+
+    if (reset) {
+        memset(&SoAd_Instance->mainfunction_timing, 0, sizeof(SoAd_Instance->mainfunction_timing));
+    }
+    return E_OK;
+}
+
+/**
+ * @brief Copy all counters, summed over cores, in one call
+ */
+Std_ReturnType SoAd_GetMeasurementSnapshot(
+        SoAd_MeasurementDataType*   data,
+        boolean                     reset
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    const uint32* src;
+    uint32*       trg;
+    uint32        index;
+    uint8         core;
+
+    SOAD_DET_CHECK_RET(SoAd_Instance->config != NULL_PTR
+                     , SOAD_API_GETANDRESETMEASUREMENTDATA
+                     , SOAD_E_NOTINIT);
+
+    SOAD_DET_CHECK_RET(data != NULL_PTR
+                     , SOAD_API_GETANDRESETMEASUREMENTDATA
+                     , SOAD_E_PARAM_POINTER);
+
+    /* all counters are uint32, so they can be summed as a flat array */
+    memset(data, 0, sizeof(*data));
+    trg = (uint32*)data;
+    for (core = 0u; core < SOAD_CFG_MEASUREMENT_CORE_COUNT; ++core) {
+        src = (const uint32*)&SoAd_Instance->measurement[core];
+        for (index = 0u; index < sizeof(*data) / sizeof(uint32); ++index) {
+            trg[index] += src[index];
+        }
+    }
+
+    if (reset) {
+        memset(SoAd_Instance->measurement, 0, sizeof(SoAd_Instance->measurement));
+    }
+
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
+        data->connections[index].buffer_high_water = SoAd_Instance->buffer_pool.con_high_water[index];
+    }
+#endif
+    return E_OK;
+}
+#endif
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+/**
+ * @brief Drain trace events of a core, oldest first
+ *
+ * @param[in]     core   core whose ring to read
+ * @param[out]    events destination for the events
+ * @param[in,out] count  size of events on entry, number of events copied on exit
+ * @param[out]    lost   events overwritten before they could be read, may be NULL_PTR
+ */
+Std_ReturnType SoAd_GetTraceEvents(
+        uint8                       core,
+        SoAd_TraceEventType*        events,
+        uint16*                     count,
+        uint32*                     lost
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    SoAd_TraceType* trace;
+    uint32          head;
+    uint32          missed = 0u;
+    uint32          len;
+    uint32          index;
+
+    SOAD_DET_CHECK_RET(core < SOAD_CFG_MEASUREMENT_CORE_COUNT
+                     , SOAD_API_GETTRACEEVENTS
+                     , SOAD_E_INV_ARG);
+
+    SOAD_DET_CHECK_RET((events != NULL_PTR) && (count != NULL_PTR)
+                     , SOAD_API_GETTRACEEVENTS
+                     , SOAD_E_PARAM_POINTER);
+
+    trace = &SoAd_Instance->trace[core];
+    head  = trace->head;
+    SOAD_CFG_ATOMIC_FENCE_ACQUIRE();
+    if (head - trace->tail > SOAD_CFG_TRACE_SIZE) {
+        missed      = head - trace->tail - SOAD_CFG_TRACE_SIZE;
+        trace->tail = head - SOAD_CFG_TRACE_SIZE;
+    }
+
+    len = head - trace->tail;
+    if (len > *count) {
+        len = *count;
+    }
+
+    for (index = 0u; index < len; ++index) {
+        events[index] = trace->events[(trace->tail + index) & (SOAD_CFG_TRACE_SIZE - 1u)];
+    }
+
+    /* drop copies of slots the writer claimed meanwhile, they may be torn */
+    SOAD_CFG_ATOMIC_FENCE_ACQUIRE();
+    head = trace->claim;
+    if (head - trace->tail > SOAD_CFG_TRACE_SIZE) {
+        uint32 stale = head - trace->tail - SOAD_CFG_TRACE_SIZE;
+        if (stale > len) {
+            stale = len;
+        }
+        memmove(events, &events[stale], (len - stale) * sizeof(*events));
+        missed      += stale;
+        len         -= stale;
+        trace->tail += stale;
+    }
+
+    trace->tail += len;
+    *count       = (uint16)len;
+    if (lost != NULL_PTR) {
+        *lost = missed;
+    }
+    return E_OK;
+}
+
+/**
+ * @brief Read a latency histogram summed over all cores
+ */
+Std_ReturnType SoAd_GetTraceHistogram(
+        uint8                       point,
+        SoAd_TraceHistogramType*    histogram,
+        boolean                     reset
+    )
+{
+    SoAd_InstanceType* const SoAd_Instance = SoAd_Instance_Get();
+    uint8 core;
+    uint8 bin;
+
+    SOAD_DET_CHECK_RET(point < SOAD_TRACE_POINT_COUNT
+                     , SOAD_API_GETTRACEHISTOGRAM
+                     , SOAD_E_INV_ARG);
+
+    SOAD_DET_CHECK_RET(histogram != NULL_PTR
+                     , SOAD_API_GETTRACEHISTOGRAM
+                     , SOAD_E_PARAM_POINTER);
+
+    memset(histogram, 0, sizeof(*histogram));
+    for (core = 0u; core < SOAD_CFG_MEASUREMENT_CORE_COUNT; ++core) {
+        SoAd_TraceHistogramType* source = &SoAd_Instance->trace[core].histograms[point];
+        for (bin = 0u; bin < 32u; ++bin) {
+            histogram->bins[bin] += source->bins[bin];
+        }
+        if (reset) {
+            memset(source, 0, sizeof(*source));
+        }
+    }
+    return E_OK;
 }
+#endif
@@ -29,7 +29,218 @@
 #include "SoAd_Cfg.h"
 
 #define SOAD_MODULEID   56u
-#define SOAD_INSTANCEID 0u
+#define SOAD_INSTANCEID 0u      /**< id of the default instance */
+
+#ifndef SOAD_CFG_ENABLE_BUFFER_POOL
+#define SOAD_CFG_ENABLE_BUFFER_POOL STD_OFF
+#endif
+
+#ifndef SOAD_CFG_ENABLE_MEASUREMENT
+#define SOAD_CFG_ENABLE_MEASUREMENT STD_OFF
+#endif
+
+#ifndef SOAD_CFG_ENABLE_TRACE
+#define SOAD_CFG_ENABLE_TRACE STD_OFF
+#endif
+
+/**
+ * @brief Number of events kept per core, must be a power of two
+ */
+#ifndef SOAD_CFG_TRACE_SIZE
+#define SOAD_CFG_TRACE_SIZE 256u
+#endif
+
+/**
+ * @brief Free running timestamp used for trace events, latencies and main function budget
+ *
+ * Should map to a cheap hardware counter, units are up to the integrator.
+ */
+#ifndef SOAD_CFG_TRACE_TIMESTAMP
+#define SOAD_CFG_TRACE_TIMESTAMP() 0u
+#endif
+
+/**
+ * @brief Number of cores updating measurement counters and trace rings
+ *
+ * Each core updates its own copy, selected by SOAD_CFG_GET_CORE_ID(),
+ * so updates need no atomic operations.
+ */
+#ifndef SOAD_CFG_MEASUREMENT_CORE_COUNT
+#define SOAD_CFG_MEASUREMENT_CORE_COUNT 1u
+#endif
+
+#ifndef SOAD_CFG_GET_CORE_ID
+#define SOAD_CFG_GET_CORE_ID() 0u
+#endif
+
+/**
+ * @brief Let SoAd_IfTransmit run in parallel to the other APIs
+ *
+ * The control context calls all other APIs and receives the TcpIp
+ * callbacks, one at a time. SoAd_IfTransmit may then be called from
+ * any number of contexts in parallel to it and to each other. It reads
+ * connection state, routing groups and socket ids atomically, and the
+ * remote address through a sequence lock, so a transmit sees either
+ * the old or the new remote, never a mix of both.
+ *
+ * This holds for connections without transmit shaping, IF retry or
+ * PDU header, in builds without in-flight tracking, and for PDUs whose
+ * upper layer takes no transmit confirmation. Transmits on other
+ * connections update state shared with the main function and must be
+ * made from the control context. Parallel callers with measurement or
+ * trace enabled need their own SOAD_CFG_GET_CORE_ID().
+ */
+#ifndef SOAD_CFG_CONCURRENT_TX
+#define SOAD_CFG_CONCURRENT_TX STD_OFF
+#endif
+
+/**
+ * @brief Atomic accesses used with SOAD_CFG_CONCURRENT_TX, GCC builtins by default
+ * @{
+ */
+#if(SOAD_CFG_CONCURRENT_TX == STD_ON)
+#ifndef SOAD_CFG_ATOMIC_LOAD
+#define SOAD_CFG_ATOMIC_LOAD(ptr)                  __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define SOAD_CFG_ATOMIC_STORE(ptr, value)          __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define SOAD_CFG_ATOMIC_LOAD_RELAXED(ptr)          __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define SOAD_CFG_ATOMIC_STORE_RELAXED(ptr, value)  __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#endif
+#else
+#define SOAD_CFG_ATOMIC_LOAD(ptr)                  (*(ptr))
+#define SOAD_CFG_ATOMIC_STORE(ptr, value)          (*(ptr) = (value))
+#define SOAD_CFG_ATOMIC_LOAD_RELAXED(ptr)          (*(ptr))
+#define SOAD_CFG_ATOMIC_STORE_RELAXED(ptr, value)  (*(ptr) = (value))
+#endif
+
+/* also ordering the trace ring, which is read from other cores */
+#ifndef SOAD_CFG_ATOMIC_FENCE_ACQUIRE
+#define SOAD_CFG_ATOMIC_FENCE_ACQUIRE()            __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define SOAD_CFG_ATOMIC_FENCE_RELEASE()            __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+/** @} */
+
+/**
+ * @brief Number of TcpIp local address ids whose assignment is tracked
+ *
+ * Groups bound to an id at or above this count, including
+ * TCPIP_LOCALADDRID_ANY, are not held back waiting for an address.
+ */
+#ifndef SOAD_CFG_LOCALADDR_COUNT
+#define SOAD_CFG_LOCALADDR_COUNT 0u
+#endif
+
+/**
+ * @brief Number of remote addresses tracked by the receive rate limiter
+ *
+ * Must be a power of two, 0 removes the rate limiter.
+ */
+#ifndef SOAD_CFG_RATELIMIT_COUNT
+#define SOAD_CFG_RATELIMIT_COUNT 0u
+#endif
+
+/**
+ * @brief Number of distinct remote addresses that can be held at once
+ *
+ * Covers the distinct configured remotes, shared by all connections
+ * using them, plus the remotes learned at runtime. The default fits
+ * one configured wildcard and a learned remote on every connection,
+ * configurations with several distinct configured remotes need more.
+ */
+#ifndef SOAD_CFG_REMOTE_COUNT
+#define SOAD_CFG_REMOTE_COUNT (SOAD_CFG_CONNECTION_COUNT + 1u)
+#endif
+
+/**
+ * @brief Number of message acceptance filters
+ *
+ * SOAD_CFG_ACCEPTFILTER_NODES bounds the prefix trie built from them at
+ * init. It must cover one root per group and domain in use plus one
+ * node per prefix bit, less bits shared by filters.
+ */
+#ifndef SOAD_CFG_ACCEPTFILTER_COUNT
+#define SOAD_CFG_ACCEPTFILTER_COUNT 0u
+#endif
+
+#ifndef SOAD_CFG_ACCEPTFILTER_NODES
+#define SOAD_CFG_ACCEPTFILTER_NODES 0u
+#endif
+
+/**
+ * @brief Number of routing groups, at most 32
+ *
+ * Enabled groups are kept as a bitset per connection, 0 removes
+ * routing groups.
+ */
+#ifndef SOAD_CFG_ROUTINGGROUP_COUNT
+#define SOAD_CFG_ROUTINGGROUP_COUNT 0u
+#endif
+
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 32u)
+#error "SOAD_CFG_ROUTINGGROUP_COUNT must fit in SoAd_RoutingGroupMaskType"
+#endif
+
+/**
+ * @brief Number of transmit priority classes
+ *
+ * Pending transmissions of class 0 are served first by the main function.
+ */
+#ifndef SOAD_CFG_TX_PRIORITY_COUNT
+#define SOAD_CFG_TX_PRIORITY_COUNT 1u
+#endif
+
+/**
+ * @brief Number of upper layers notified of connection mode changes
+ */
+#ifndef SOAD_CFG_MODECHG_COUNT
+#define SOAD_CFG_MODECHG_COUNT 0u
+#endif
+
+/**
+ * @brief Number of unconfirmed transmissions tracked per connection
+ *
+ * IF PDUs sent over TCP are confirmed once TcpIp reports all their
+ * bytes acknowledged, UDP ones from the next main function. A connection
+ * with all records in use refuses further transmissions. 0 removes
+ * tracking, IF PDUs are then confirmed from the next main function
+ * once TcpIp accepted them.
+ */
+#ifndef SOAD_CFG_TX_INFLIGHT_SIZE
+#define SOAD_CFG_TX_INFLIGHT_SIZE 0u
+#endif
+
+/**
+ * @brief Storage class of the selected instance, see SoAd_SetInstance
+ *
+ * Empty if all callers share one selection. Hosts running instances
+ * in parallel threads can set it to _Thread_local.
+ */
+#ifndef SOAD_CFG_INSTANCE_LOCAL
+#define SOAD_CFG_INSTANCE_LOCAL
+#endif
+
+/**
+ * @brief Number of cores keeping their own instance selection
+ *
+ * Each core selects through SOAD_CFG_GET_CORE_ID(), so one instance
+ * per core works without thread local storage. The selection is looked
+ * up once when an API is entered. Must not be above
+ * SOAD_CFG_MEASUREMENT_CORE_COUNT with measurement or trace enabled.
+ */
+#ifndef SOAD_CFG_INSTANCE_CORE_COUNT
+#define SOAD_CFG_INSTANCE_CORE_COUNT 1u
+#endif
+
+#if((SOAD_CFG_ENABLE_MEASUREMENT == STD_ON) || (SOAD_CFG_ENABLE_TRACE == STD_ON)) \
+&& (SOAD_CFG_INSTANCE_CORE_COUNT > SOAD_CFG_MEASUREMENT_CORE_COUNT)
+#error "SOAD_CFG_INSTANCE_CORE_COUNT cores need their own measurement data"
+#endif
+
+/**
+ * @brief Size of the buffer IF PDUs are fetched into by SoAd_IfRoutingGroupTransmit
+ */
+#ifndef SOAD_CFG_IFTRIGGER_SIZE
+#define SOAD_CFG_IFTRIGGER_SIZE 128u
+#endif
 
 /**
  * @brief Development Errors
@@ -90,8 +301,25 @@
 #define SOAD_API_INIT                         0x01u
 #define SOAD_API_IFTRANSMIT                   0x03u
 #define SOAD_API_TPTRANSMIT                   0x04u
+#define SOAD_API_IFROUTINGGROUPTRANSMIT       0x06u
+#define SOAD_API_OPENSOCON                    0x08u
+#define SOAD_API_CLOSESOCON                   0x09u
+#define SOAD_API_ENABLEROUTING                0x0Eu
+#define SOAD_API_DISABLEROUTING               0x0Fu
 #define SOAD_API_RXINDICATION                 0x12u
 #define SOAD_API_TCPIPEVENT                   0x16u
+#define SOAD_API_SETREMOTEADDR                0x1Cu
+#define SOAD_API_ENABLESPECIFICROUTING        0x20u
+#define SOAD_API_SETUNIQUEREMOTEADDR          0x2Eu
+#define SOAD_API_RELEASEREMOTEADDR            0x2Fu
+#define SOAD_API_GETREMOTEADDR                0x4Bu
+#define SOAD_API_LOCALIPADDRASSIGNMENTCHG     0x18u
+#define SOAD_API_GETANDRESETMEASUREMENTDATA   0x45u
+#define SOAD_API_GETTRACEEVENTS               0x80u /**< vendor specific */
+#define SOAD_API_GETMAINFUNCTIONSTATS         0x82u /**< vendor specific */
+#define SOAD_API_OPENSOCONGROUP               0x83u /**< vendor specific */
+#define SOAD_API_CLOSESOCONGROUP              0x84u /**< vendor specific */
+#define SOAD_API_GETTRACEHISTOGRAM            0x81u /**< vendor specific */
 
 /**
  * @}
@@ -107,8 +335,29 @@ typedef uint8 SoAd_SoConIdType;
 typedef uint8 SoAd_SoGrpIdType;
 typedef uint8 SoAd_SocketRouteIdType;
 
+typedef uint16 SoAd_BufferIdType;
+typedef uint16 SoAd_RemoteIdType;
+typedef uint8 SoAd_MeasurementIdxType;
+typedef uint16 SoAd_RoutingGroupIdType;
+typedef uint32 SoAd_RoutingGroupMaskType;                /**< bit n set for routing group n */
+
+#define SOAD_SOCONID_INVALID       (SoAd_SoConIdType)(-1)
 #define SOAD_SOCKETROUTEID_INVALID (SoAd_SocketRouteIdType)(-1)
 #define SOAD_PDUHEADERID_INVALID   (uint32)(-1)
+#define SOAD_BUFFERID_INVALID      (SoAd_BufferIdType)(-1)
+#define SOAD_REMOTEID_INVALID      (SoAd_RemoteIdType)(-1)
+#define SOAD_PDUID_INVALID         (PduIdType)(-1)
+
+/**
+ * @brief Measurement indexes
+ * @{
+ */
+#define SOAD_MEAS_DROP_TCP         (SoAd_MeasurementIdxType)0x01u /**< TCP PDUs dropped for lack of a matching connection */
+#define SOAD_MEAS_DROP_UDP         (SoAd_MeasurementIdxType)0x02u /**< UDP PDUs dropped for lack of a matching connection */
+#define SOAD_MEAS_ALL              (SoAd_MeasurementIdxType)0xFFu
+/**
+ * @}
+ */
 
 
 typedef enum {
@@ -151,6 +400,41 @@ typedef struct {
         );
 } SoAd_TpTxType;
 
+typedef struct {
+    SoAd_SoConIdType                  connection;
+    SoAd_SoConStateType               mode;               /**< mode at end of the main function cycle */
+} SoAd_SoConModeChgEventType;
+
+/**
+ * @brief Upper layer notified of connection mode changes
+ *
+ * Changes are collected over a main function cycle and reported in one
+ * call, each connection at most once with its latest mode.
+ */
+typedef struct {
+    void (*mode_chg)(
+            const SoAd_SoConModeChgEventType* events,
+            uint16                            count
+        );
+} SoAd_SoConModeChgType;
+
+typedef struct {
+    Std_ReturnType (*trigger_transmit)(
+            PduIdType               id,
+            PduInfoType*            info
+        );
+
+    void (*tx_confirmation)(
+            PduIdType               id
+        );
+
+    /** all PDUs confirmed together in one call, NULL_PTR to use tx_confirmation per PDU */
+    void (*tx_confirmations)(
+            const PduIdType*        ids,
+            uint16                  count
+        );
+} SoAd_IfTxType;
+
 typedef struct {
     const SoAd_TpRxType*              upper;
     PduIdType                         pdu;                /**< SoAdRxPduRef */
@@ -159,8 +443,50 @@ typedef struct {
 typedef struct {
     uint32                            header_id;          /**< SoAdRxPduHeaderId   */
     SoAd_SocketRouteDestType          destination;        /**< SoAdSocketRouteDest */
+    SoAd_RoutingGroupMaskType         routing_groups;     /**< SoAdRxRoutingGroupRef, 0 if always enabled */
 } SoAd_SocketRouteType;
 
+/**
+ * @brief Backoff between attempts to open a socket
+ *
+ * Delays are given in main function cycles. After each consecutive
+ * failure the delay is multiplied, up to max, and a random number of
+ * cycles up to jitter is added to spread out retries of many sockets.
+ */
+typedef struct {
+    uint16                            initial;            /**< delay after first failure, 0 to retry every cycle */
+    uint16                            max;                /**< upper limit of delay */
+    uint8                             multiplier;         /**< growth of delay per consecutive failure */
+    uint16                            jitter;             /**< max random cycles added to each delay */
+} SoAd_RetryConfigType;
+
+/**
+ * @brief Token bucket limiting datagrams accepted per remote address
+ *
+ * Each remote address of a group may burst up to burst datagrams,
+ * refilled by rate datagrams every period main function cycles.
+ */
+typedef struct {
+    uint16                            rate;               /**< datagrams added per period, 0 for no limit */
+    uint16                            period;             /**< main function cycles per refill, not 0 when rate is set */
+    uint16                            burst;              /**< max datagrams accepted back to back */
+} SoAd_RateLimitConfigType;
+
+/**
+ * @brief Token bucket shaping bytes transmitted by a connection or group
+ *
+ * Up to burst bytes may be sent back to back, refilled by rate bytes
+ * every period main function cycles. Transmissions over budget are held
+ * back to a later main function. Held IF PDUs are copied to the buffer
+ * pool, without one they are rejected instead. TP data over TCP goes
+ * out in chunks of at most the tokens left and burst.
+ */
+typedef struct {
+    uint32                            rate;               /**< bytes added per period, 0 for no shaping */
+    uint16                            period;             /**< main function cycles per refill, not 0 when rate is set */
+    uint32                            burst;              /**< max bytes sent back to back, at most 0x7fffffff */
+} SoAd_TxShapeConfigType;
+
 typedef struct {
     uint16                            localport;          /**< SoAdSocketLocalPort */
     TcpIp_LocalAddrIdType             localaddr;          /**< SoAdSocketLocalAddressRef */
@@ -171,33 +497,214 @@ typedef struct {
     boolean                           listen_only;        /**< SoAdSocketUdpListenOnly */
     boolean                           header;             /**< SoAdPduHeaderEnable */
     SoAd_SocketRouteIdType            socket_route_id;
+    uint32                            buffer_quota;       /**< max bytes of pool buffers held by the group, 0 for no limit */
+    uint16                            udp_alive_timeout;  /**< SoAdSocketUdpAliveSupervisionTimeout in main function cycles, 0 to disable */
+    uint16                            tp_tx_timeout;      /**< main function cycles without TP transmit progress before abort, 0 to disable */
+    SoAd_RetryConfigType              retry;              /**< backoff of failed socket opens and TCP connects */
+    boolean                           keep_socket;        /**< keep a bound socket ready for reconnects of own sockets */
+    uint32                            rx_window_threshold; /**< consumed TCP bytes that reopen the window at once, 0 to only update from main function */
+    SoAd_RateLimitConfigType          rx_limit;           /**< per remote limit on datagrams received on the group socket */
+    boolean                           accept_filter;      /**< SoAdSocketMsgAcceptanceFilterEnabled, unknown remotes must match a filter of the group */
+    uint32                            mode_chg;           /**< SoAdSocketSoConModeChgNotification, bit n set to notify mode_chg[n] of the config */
+    SoAd_TxShapeConfigType            tx_shape;           /**< limit on bytes transmitted by all members together */
 } SoAd_SoGrpConfigType;
 
+/**
+ * @brief Message acceptance filter for remotes of a group
+ *
+ * Address words are compared most significant bit first, in the word
+ * order of TcpIp_SockAddrInet6Type for IPv6.
+ */
+typedef struct {
+    SoAd_SoGrpIdType                  group;
+    TcpIp_DomainType                  domain;
+    uint32                            addr[4];            /**< only addr[0] used for IPv4 */
+    uint8                             prefix;             /**< leading address bits that must match */
+    uint16                            port_min;
+    uint16                            port_max;           /**< inclusive, 0xffff for any */
+} SoAd_AcceptFilterType;
+
 typedef struct {
     SoAd_SoGrpIdType             group;
     const TcpIp_SockAddrType*    remote;
     SoAd_SocketRouteIdType       socket_route_id;
+    uint32                       buffer_quota;       /**< max bytes of pool buffers held by the connection, 0 for no limit */
+    uint8                        tx_priority;        /**< transmit priority class, 0 highest */
+    SoAd_TxShapeConfigType       tx_shape;           /**< limit on bytes transmitted by the connection */
+    uint8                        if_retry;           /**< IF PDUs held for retry while offline or refused by TcpIp, also bounds PDUs held by shaping, 0 to drop them, needs SOAD_CFG_ENABLE_BUFFER_POOL */
 } SoAd_SoConConfigType;
 
 typedef struct {
-    uint32                                  header_id;
+    uint32                                  header_id;          /**< SoAdTxPduHeaderId, sent ahead of the PDU if the group has SoAdPduHeaderEnable */
     SoAd_SoConIdType                        connection;
+    SoAd_RoutingGroupMaskType               routing_groups;     /**< SoAdTxRoutingGroupRef, 0 if always enabled */
 } SoAd_PduRouteDestType;
 
 typedef struct {
     PduIdType                               pdu_id;
     const SoAd_TpTxType*                    upper;
+    const SoAd_IfTxType*                    upper_if;           /**< IF upper layer, NULL_PTR if none */
+    uint8                                   priority;           /**< transmit priority class, 0 highest, no higher than that of the connection */
     SoAd_PduRouteDestType                   destination;
 } SoAd_PduRouteType;
 
+/**
+ * @brief Size class of the shared buffer pool
+ *
+ * Classes must be sorted by ascending size. The sum of size * count
+ * over all classes must fit in SOAD_CFG_BUFFER_ARENA_SIZE and the sum
+ * of count must not exceed SOAD_CFG_BUFFER_COUNT.
+ */
+typedef struct {
+    uint16                            size;               /**< size of each buffer in class */
+    uint16                            count;              /**< number of buffers in class */
+} SoAd_BufferClassType;
+
 typedef struct {
     const SoAd_SoGrpConfigType*  groups       [SOAD_CFG_CONNECTIONGROUP_COUNT];
     const SoAd_SoConConfigType*  connections  [SOAD_CFG_CONNECTION_COUNT];
     const SoAd_PduRouteType*     pdu_routes   [SOAD_CFG_PDUROUTE_COUNT];
     const SoAd_SocketRouteType*  socket_routes[SOAD_CFG_SOCKETROUTE_COUNT];
+#if(SOAD_CFG_ENABLE_BUFFER_POOL == STD_ON)
+    const SoAd_BufferClassType*  buffer_classes[SOAD_CFG_BUFFERCLASS_COUNT];
+#endif
+#if(SOAD_CFG_ACCEPTFILTER_COUNT > 0u)
+    const SoAd_AcceptFilterType* accept_filters[SOAD_CFG_ACCEPTFILTER_COUNT];
+#endif
+#if(SOAD_CFG_MODECHG_COUNT > 0u)
+    const SoAd_SoConModeChgType* mode_chg      [SOAD_CFG_MODECHG_COUNT];
+#endif
+    SoAd_RoutingGroupMaskType    routing_init;       /**< SoAdRoutingGroupIsEnabledAtInit of each routing group */
+    uint16                       main_budget;        /**< requests and connections handled per main function, 0 for all */
+    uint16                       tx_budget;          /**< pending transmissions served per main function, 0 for all */
+    uint32                       main_cycles;        /**< SOAD_CFG_TRACE_TIMESTAMP() units per main function, 0 for unlimited */
 } SoAd_ConfigType;
 
+/**
+ * @brief Counters of a socket connection
+ */
+typedef struct {
+    uint32                                  rx_pdus;
+    uint32                                  rx_bytes;
+    uint32                                  tx_pdus;
+    uint32                                  tx_bytes;
+    uint32                                  rx_drop_buffer;     /**< upper layer or SoAd lacked buffer */
+    uint32                                  rx_drop_route;      /**< no socket route to deliver to */
+    uint32                                  tx_drop_offline;    /**< transmit while not online */
+    uint32                                  tx_drop_tcpip;      /**< transmit refused by TcpIp */
+    uint32                                  state_changes;
+    uint32                                  buffer_high_water;  /**< max bytes of pool buffers held */
+} SoAd_SoConCountersType;
+
+/**
+ * @brief Counters of a PDU route
+ */
+typedef struct {
+    uint32                                  tx_pdus;
+    uint32                                  tx_bytes;
+    uint32                                  tx_dropped;
+} SoAd_PduRouteCountersType;
+
+/**
+ * @brief Counters of a socket route
+ */
+typedef struct {
+    uint32                                  rx_pdus;
+    uint32                                  rx_bytes;
+    uint32                                  rx_dropped;
+} SoAd_SocketRouteCountersType;
+
+/**
+ * @brief Execution time statistics of SoAd_MainFunction in SOAD_CFG_TRACE_TIMESTAMP() units
+ */
+typedef struct {
+    uint32                                  calls;
+    uint32                                  min;
+    uint32                                  max;
+    uint32                                  avg;
+    uint32                                  exhausted;          /**< calls stopped by budget before visiting all connections */
+} SoAd_MainFunctionStatsType;
+
+/**
+ * @brief Counters of the whole module
+ */
+typedef struct {
+    uint32                                  drop_tcp;           /**< SOAD_MEAS_DROP_TCP */
+    uint32                                  drop_udp;           /**< SOAD_MEAS_DROP_UDP */
+    uint32                                  lookup_miss;        /**< indication on unknown socket */
+    uint32                                  rx_rate_limited;    /**< datagrams dropped by the receive rate limiter */
+    uint32                                  rx_filtered;        /**< datagrams and connections refused by acceptance filters */
+    SoAd_SoConCountersType                  connections  [SOAD_CFG_CONNECTION_COUNT];
+    SoAd_PduRouteCountersType               pdu_routes   [SOAD_CFG_PDUROUTE_COUNT];
+    SoAd_SocketRouteCountersType            socket_routes[SOAD_CFG_SOCKETROUTE_COUNT];
+} SoAd_MeasurementDataType;
+
+/**
+ * @brief Traced code points
+ * @{
+ */
+#define SOAD_TRACE_RXINDICATION 0u
+#define SOAD_TRACE_IFTRANSMIT   1u
+#define SOAD_TRACE_TPTRANSMIT   2u
+#define SOAD_TRACE_MAINFUNCTION 3u
+#define SOAD_TRACE_POINT_COUNT  4u  /**< points with a latency histogram */
+#define SOAD_TRACE_STATE        4u  /**< connection state change, length holds the new state */
+/**
+ * @}
+ */
+
+#define SOAD_TRACE_FLAG_EXIT    0x80u
+
+/**
+ * @brief Binary trace record, also the format of a dumped trace file
+ */
+typedef struct {
+    uint32                                  timestamp;
+    uint8                                   point;      /**< SOAD_TRACE_*, or'ed with SOAD_TRACE_FLAG_EXIT */
+    uint8                                   result;
+    SoAd_SoConIdType                        connection;
+    uint16                                  route;
+    uint16                                  length;
+} SoAd_TraceEventType;
+
+/**
+ * @brief Log2 latency histogram, bin n counts latencies in [2^(n-1), 2^n)
+ */
+typedef struct {
+    uint32                                  bins[32];
+} SoAd_TraceHistogramType;
+
+/**
+ * @brief State of one SoAd instance, held in memory provided by the caller
+ */
+typedef struct SoAd_InstanceType SoAd_InstanceType;
+
 void SoAd_Init(const SoAd_ConfigType* config);
+
+uint32 SoAd_GetInstanceSize(const SoAd_ConfigType* config);
+
+SoAd_InstanceType* SoAd_InitInstance(
+        void*                       memory,
+        uint8                       instance_id,
+        const SoAd_ConfigType*      config
+    );
+
+SoAd_InstanceType* SoAd_SetInstance(SoAd_InstanceType* instance);
+
+void SoAd_MainFunctionInstance(SoAd_InstanceType* instance);
+
+Std_ReturnType SoAd_IfTransmitInstance(
+        SoAd_InstanceType*  instance,
+        PduIdType           pdu_id,
+        const PduInfoType*  pdu_info
+    );
+
+Std_ReturnType SoAd_TpTransmitInstance(
+        SoAd_InstanceType*  instance,
+        PduIdType           pdu_id,
+        const PduInfoType*  pdu_info
+    );
+
 void SoAd_MainFunction(void);
 
 Std_ReturnType SoAd_IfTransmit(
@@ -210,4 +717,94 @@ Std_ReturnType SoAd_TpTransmit(
         const PduInfoType*          pdu_info
     );
 
+Std_ReturnType SoAd_OpenSoCon(
+        SoAd_SoConIdType            id
+    );
+
+Std_ReturnType SoAd_CloseSoCon(
+        SoAd_SoConIdType            id,
+        boolean                     abort
+    );
+
+Std_ReturnType SoAd_OpenSoConGroup(
+        SoAd_SoGrpIdType            id
+    );
+
+Std_ReturnType SoAd_CloseSoConGroup(
+        SoAd_SoGrpIdType            id,
+        boolean                     abort
+    );
+
+#if(SOAD_CFG_ROUTINGGROUP_COUNT > 0u)
+Std_ReturnType SoAd_EnableRouting(
+        SoAd_RoutingGroupIdType     id
+    );
+
+Std_ReturnType SoAd_EnableSpecificRouting(
+        SoAd_RoutingGroupIdType     id,
+        SoAd_SoConIdType            id_con
+    );
+
+Std_ReturnType SoAd_DisableRouting(
+        SoAd_RoutingGroupIdType     id
+    );
+
+Std_ReturnType SoAd_IfRoutingGroupTransmit(
+        SoAd_RoutingGroupIdType     id
+    );
+#endif
+
+Std_ReturnType SoAd_SetRemoteAddr(
+        SoAd_SoConIdType            id,
+        const TcpIp_SockAddrType*   remote
+    );
+
+Std_ReturnType SoAd_SetUniqueRemoteAddr(
+        SoAd_SoConIdType            id,
+        const TcpIp_SockAddrType*   remote,
+        SoAd_SoConIdType*           assigned
+    );
+
+Std_ReturnType SoAd_GetRemoteAddr(
+        SoAd_SoConIdType            id,
+        TcpIp_SockAddrType*         remote
+    );
+
+void SoAd_ReleaseRemoteAddr(
+        SoAd_SoConIdType            id
+    );
+
+#if(SOAD_CFG_ENABLE_MEASUREMENT == STD_ON)
+Std_ReturnType SoAd_GetAndResetMeasurementData(
+        SoAd_MeasurementIdxType     idx,
+        boolean                     reset,
+        uint32*                     data
+    );
+
+Std_ReturnType SoAd_GetMeasurementSnapshot(
+        SoAd_MeasurementDataType*   data,
+        boolean                     reset
+    );
+
+Std_ReturnType SoAd_GetMainFunctionStats(
+        SoAd_MainFunctionStatsType* stats,
+        boolean                     reset
+    );
+#endif
+
+#if(SOAD_CFG_ENABLE_TRACE == STD_ON)
+Std_ReturnType SoAd_GetTraceEvents(
+        uint8                       core,
+        SoAd_TraceEventType*        events,
+        uint16*                     count,
+        uint32*                     lost
+    );
+
+Std_ReturnType SoAd_GetTraceHistogram(
+        uint8                       point,
+        SoAd_TraceHistogramType*    histogram,
+        boolean                     reset
+    );
+#endif
+
 #endif
@@ -54,6 +54,11 @@ void SoAd_TcpConnected(
         TcpIp_SocketIdType 			socket_id
     );
 
+void SoAd_LocalIpAddrAssignmentChg(
+        TcpIp_LocalAddrIdType       id,
+        TcpIp_IpAddrStateType       state
+    );
+
 BufReq_ReturnType SoAd_CopyTxData(
         TcpIp_SocketIdType 			socket_id,
         uint8* 						buf,
@@ -23,8 +23,35 @@
 #define SOAD_CFG_ENABLE_DEVELOPMENT_ERROR STD_ON
 
  #define SOAD_CFG_SOCKETROUTE_COUNT     3u
- #define SOAD_CFG_PDUROUTE_COUNT        1u
- #define SOAD_CFG_CONNECTIONGROUP_COUNT 3u
- #define SOAD_CFG_CONNECTION_COUNT      5u
+ #define SOAD_CFG_PDUROUTE_COUNT        2u
+ #define SOAD_CFG_CONNECTIONGROUP_COUNT 4u
+ #define SOAD_CFG_CONNECTION_COUNT      6u
+ #define SOAD_CFG_LOCALADDR_COUNT       1u
+ #define SOAD_CFG_RATELIMIT_COUNT       8u
+ #define SOAD_CFG_ACCEPTFILTER_COUNT    3u
+ #define SOAD_CFG_ACCEPTFILTER_NODES    80u
+ #define SOAD_CFG_ROUTINGGROUP_COUNT    2u
+ #define SOAD_CFG_MODECHG_COUNT         2u
+ #define SOAD_CFG_TX_PRIORITY_COUNT     2u
+ #define SOAD_CFG_TX_INFLIGHT_SIZE      4u
+
+#define SOAD_CFG_ENABLE_BUFFER_POOL       STD_ON
+#define SOAD_CFG_ENABLE_MEASUREMENT       STD_ON
+#define SOAD_CFG_ENABLE_TRACE             STD_ON
+
+ #define SOAD_CFG_TRACE_SIZE            16u
+ #define SOAD_CFG_TRACE_TIMESTAMP()     suite_timestamp()
+
+extern uint32 suite_timestamp(void);
+
+ #define SOAD_CFG_MEASUREMENT_CORE_COUNT 2u
+ #define SOAD_CFG_INSTANCE_CORE_COUNT   2u
+ #define SOAD_CFG_GET_CORE_ID()         suite_core_id
+
+extern uint32 suite_core_id;
+
+ #define SOAD_CFG_BUFFERCLASS_COUNT     2u
+ #define SOAD_CFG_BUFFER_COUNT          6u
+ #define SOAD_CFG_BUFFER_ARENA_SIZE     768u
 
 #endif /* SOAD_CFG_H_ */
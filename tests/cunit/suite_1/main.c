@@ -17,24 +17,55 @@
 
 #include "SoAd.c"
 
+/* tests look at the instance selected for the calling context */
+#define SoAd_Instance SoAd_Instance_Get()
+#include "SoAd_TraceFile.c"
+
 #include "CUnit/Basic.h"
 #include "CUnit/Automated.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
 struct suite_socket_state {
     boolean retrieve;
     boolean bound;
     boolean listen;
     boolean connect;
+    uint32  received;
+    uint32  received_calls;
+    uint32  transmit_calls;
 };
 
 struct suite_rxpdu_state {
     boolean rx_tp_active;
     uint32  rx_count;
+    uint32  tx_confirmed;
+    uint32  if_confirmed;
+    uint32  tx_available;
+    uint32  tx_copied;
 };
 
 struct suite_state {
     TcpIp_SocketIdType socket_id;
     uint16             port_index;
+    PduLengthType      rx_space;
+    boolean            fail_rx;
+    uint32             det_expected;       /**< errors the running test provokes */
+    boolean            fail_socket;
+    boolean            fail_transmit;
+    uint32             trigger_calls;
+    uint32             if_batches;
+    uint32             if_resend;          /**< confirmations that transmit again */
+    uint32             tx_copy_limit;      /**< most bytes pulled per transmit, 0 for all */
+    uint8              tx_wire[32];        /**< start of the last transmitted data */
+    uint32             tx_wire_length;
+
+    struct {
+        uint32                     calls;
+        uint16                     count;
+        SoAd_SoConModeChgEventType events[SOAD_CFG_CONNECTION_COUNT];
+    } mode_chg[SOAD_CFG_MODECHG_COUNT];
 
     struct suite_socket_state sockets[100];
     struct suite_rxpdu_state  rxpdu[100];
@@ -42,6 +73,16 @@ struct suite_state {
 
 struct suite_state suite_state;
 
+uint32 suite_timestamp_value;
+
+uint32 suite_core_id;
+
+uint32 suite_timestamp(void)
+{
+    /* each read advances time, so every traced call takes a few ticks */
+    return suite_timestamp_value++;
+}
+
 Std_ReturnType Det_ReportError(
         uint16 ModuleId,
         uint8 InstanceId,
@@ -51,6 +92,10 @@ Std_ReturnType Det_ReportError(
 {
     CU_ASSERT_EQUAL(ModuleId  , SOAD_MODULEID);
     CU_ASSERT_EQUAL(InstanceId, 0u);
+    if (suite_state.det_expected > 0u) {
+        suite_state.det_expected--;
+        return E_OK;
+    }
     CU_ASSERT_TRUE(FALSE);
     return E_OK;
 }
@@ -61,12 +106,47 @@ Std_ReturnType TcpIp_SoAdGetSocket(
         TcpIp_SocketIdType*         id
     )
 {
+    if (suite_state.fail_socket) {
+        return E_NOT_OK;
+    }
     *id = ++suite_state.socket_id;
     suite_state.sockets[*id].retrieve = TRUE;
     return E_OK;
 }
 
 
+static void suite_keep_tx(const uint8* data, uint32 len)
+{
+    uint32 offset = suite_state.tx_wire_length;
+
+    if (offset < sizeof(suite_state.tx_wire)) {
+        memcpy(&suite_state.tx_wire[offset], data
+             , ((sizeof(suite_state.tx_wire) - offset) < len) ? (sizeof(suite_state.tx_wire) - offset) : len);
+    }
+    suite_state.tx_wire_length += len;
+}
+
+/* TcpIp pulls data of a transmit without buffer in parts */
+static Std_ReturnType suite_copy_tx(TcpIp_SocketIdType id, uint32 available)
+{
+    static uint8 chunk[1024];
+    uint16       len;
+
+    suite_state.tx_wire_length = 0u;
+    if ((suite_state.tx_copy_limit != 0u) && (available > suite_state.tx_copy_limit)) {
+        available = suite_state.tx_copy_limit;
+    }
+    while (available > 0u) {
+        len = (available > sizeof(chunk)) ? (uint16)sizeof(chunk) : (uint16)available;
+        if (SoAd_CopyTxData(id, chunk, len) != BUFREQ_OK) {
+            return E_NOT_OK;
+        }
+        suite_keep_tx(chunk, len);
+        available -= len;
+    }
+    return E_OK;
+}
+
 Std_ReturnType TcpIp_UdpTransmit(
         TcpIp_SocketIdType          id,
         const uint8*                data,
@@ -74,6 +154,16 @@ Std_ReturnType TcpIp_UdpTransmit(
         uint16                      len
     )
 {
+    if (suite_state.fail_transmit) {
+        return E_NOT_OK;
+    }
+    CU_ASSERT_FATAL(id < 100u);
+    suite_state.sockets[id].transmit_calls++;
+    if (data == NULL_PTR) {
+        return suite_copy_tx(id, len);
+    }
+    suite_state.tx_wire_length = 0u;
+    suite_keep_tx(data, len);
     return E_OK;
 }
 
@@ -84,6 +174,15 @@ Std_ReturnType TcpIp_TcpTransmit(
         boolean             force
     )
 {
+    if (suite_state.fail_transmit) {
+        return E_NOT_OK;
+    }
+    suite_state.sockets[id].transmit_calls++;
+    if (data == NULL_PTR) {
+        return suite_copy_tx(id, aailable);
+    }
+    suite_state.tx_wire_length = 0u;
+    suite_keep_tx(data, aailable);
     return E_OK;
 }
 
@@ -92,6 +191,8 @@ Std_ReturnType TcpIp_TcpReceived(
         uint32             len
     )
 {
+    suite_state.sockets[id].received += len;
+    suite_state.sockets[id].received_calls++;
     return E_OK;
 }
 
@@ -166,8 +267,11 @@ BufReq_ReturnType PduR_SoAdTpCopyRxData(
         PduLengthType*          buf_len
     )
 {
+    if (suite_state.fail_rx) {
+        return BUFREQ_E_NOT_OK;
+    }
     suite_state.rxpdu[id].rx_count += info->SduLength;
-    *buf_len = (PduLengthType)0xffffu;
+    *buf_len = suite_state.rx_space;
     return E_OK;
 }
 
@@ -217,6 +321,17 @@ BufReq_ReturnType PduR_SoAdTpCopyTxData(
         PduLengthType*          available
     )
 {
+    struct suite_rxpdu_state* pdu = &suite_state.rxpdu[id];
+
+    if (info->SduLength > pdu->tx_available) {
+        return BUFREQ_E_NOT_OK;
+    }
+    if (info->SduLength != 0u) {
+        memset(info->SduDataPtr, 0xa0 + (int)id, info->SduLength);
+    }
+    pdu->tx_available -= info->SduLength;
+    pdu->tx_copied    += info->SduLength;
+    *available = (pdu->tx_available > 0xffffu) ? 0xffffu : (PduLengthType)pdu->tx_available;
     return BUFREQ_OK;
 }
 
@@ -225,22 +340,30 @@ void PduR_SoAdTpTxConfirmation(
         Std_ReturnType          result
     )
 {
+    suite_state.rxpdu[id].tx_confirmed++;
 }
 
 #define SOCKET_GRP1      0
 #define SOCKET_GRP2      1
 #define SOCKET_GRP3      2
+#define SOCKET_GRP4      3
 
 #define SOCKET_GRP1_CON1 0
 #define SOCKET_GRP1_CON2 1
 #define SOCKET_GRP2_CON1 2
 #define SOCKET_GRP2_CON2 3
 #define SOCKET_GRP3_CON1 4
+#define SOCKET_GRP4_CON1 5
+
+#define SOCKET_LOCALADDR 0
 
 #define SOCKET_ROUTE1    0
 #define SOCKET_ROUTE2    1
 #define SOCKET_ROUTE3    2
 
+#define ROUTING_GRP1     0
+#define ROUTING_GRP2     1
+
 const SoAd_TpRxType suite_tp = {
         .rx_indication      = PduR_SoAdTpRxIndication,
         .copy_rx_data       = PduR_SoAdTpCopyRxData,
@@ -258,6 +381,71 @@ const SoAd_TpTxType suite_tptx = {
         .tx_confirmation    = PduR_SoAdTpTxConfirmation,
 };
 
+Std_ReturnType PduR_SoAdIfTriggerTransmit(
+        PduIdType               id,
+        PduInfoType*            info
+    )
+{
+    suite_state.trigger_calls++;
+    CU_ASSERT_EQUAL_FATAL(info->SduLength, SOAD_CFG_IFTRIGGER_SIZE);
+    memset(info->SduDataPtr, 0x5a, 8u);
+    info->SduLength = 8u;
+    return E_OK;
+}
+
+void PduR_SoAdIfTxConfirmation(
+        PduIdType               id
+    )
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    suite_state.rxpdu[id].if_confirmed++;
+    if (suite_state.if_resend > 0u) {
+        suite_state.if_resend--;
+        CU_ASSERT_EQUAL(SoAd_IfTransmit(id, &info), E_OK);
+    }
+}
+
+static void suite_if_confirmations(const PduIdType* ids, uint16 count)
+{
+    uint16 index;
+    suite_state.if_batches++;
+    for (index = 0u; index < count; ++index) {
+        suite_state.rxpdu[ids[index]].if_confirmed++;
+    }
+}
+
+static void suite_mode_chg(uint8 upper, const SoAd_SoConModeChgEventType* events, uint16 count)
+{
+    suite_state.mode_chg[upper].calls++;
+    suite_state.mode_chg[upper].count = count;
+    memcpy(suite_state.mode_chg[upper].events, events, count * sizeof(*events));
+}
+
+static void SoAd_SoConModeChg_Sd(const SoAd_SoConModeChgEventType* events, uint16 count)
+{
+    suite_mode_chg(0u, events, count);
+}
+
+static void SoAd_SoConModeChg_BswM(const SoAd_SoConModeChgEventType* events, uint16 count)
+{
+    suite_mode_chg(1u, events, count);
+}
+
+const SoAd_SoConModeChgType suite_mode_chg_sd = {
+        .mode_chg           = SoAd_SoConModeChg_Sd,
+};
+
+const SoAd_SoConModeChgType suite_mode_chg_bswm = {
+        .mode_chg           = SoAd_SoConModeChg_BswM,
+};
+
+const SoAd_IfTxType suite_iftx = {
+        .trigger_transmit   = PduR_SoAdIfTriggerTransmit,
+        .tx_confirmation    = PduR_SoAdIfTxConfirmation,
+};
+
 const TcpIp_SockAddrInetType socket_remote_any_v4 = {
     .domain  = TCPIP_AF_INET,
     .addr[0] = TCPIP_IPADDR_ANY,
@@ -277,7 +465,9 @@ const SoAd_SoGrpConfigType           socket_group_1 = {
     .protocol  = TCPIP_IPPROTO_TCP,
     .automatic = TRUE,
     .initiate  = FALSE,
-    .socket_route_id = SOAD_SOCKETROUTEID_INVALID
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    .rx_window_threshold = 150u,
+    .mode_chg  = 1u << 0,
 };
 
 const SoAd_SoGrpConfigType           socket_group_2 = {
@@ -287,7 +477,15 @@ const SoAd_SoGrpConfigType           socket_group_2 = {
     .protocol  = TCPIP_IPPROTO_UDP,
     .automatic = TRUE,
     .initiate  = FALSE,
-    .socket_route_id = SOAD_SOCKETROUTEID_INVALID
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    .udp_alive_timeout = 3u,
+    .rx_limit  = {
+        .rate   = 1u,
+        .period = 2u,
+        .burst  = 3u,
+    },
+    .accept_filter = TRUE,
+    .mode_chg  = (1u << 0) | (1u << 1),
 };
 
 const SoAd_SoGrpConfigType           socket_group_3 = {
@@ -297,7 +495,23 @@ const SoAd_SoGrpConfigType           socket_group_3 = {
     .protocol  = TCPIP_IPPROTO_TCP,
     .automatic = TRUE,
     .initiate  = TRUE,
-    .socket_route_id = SOAD_SOCKETROUTEID_INVALID
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    .retry     = {
+            .initial    = 2u,
+            .max        = 8u,
+            .multiplier = 2u,
+    },
+    .keep_socket = TRUE,
+};
+
+const SoAd_SoGrpConfigType           socket_group_4 = {
+    .localport = 8002,
+    .localaddr = SOCKET_LOCALADDR,
+    .domain    = TCPIP_AF_INET,
+    .protocol  = TCPIP_IPPROTO_UDP,
+    .automatic = TRUE,
+    .initiate  = FALSE,
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
 };
 
 const SoAd_SocketRouteType           socket_route_1 = {
@@ -313,7 +527,8 @@ const SoAd_SocketRouteType           socket_route_2 = {
         .destination = {
                 .upper      = &suite_if,
                 .pdu        = 1u
-        }
+        },
+        .routing_groups = 1u << ROUTING_GRP2,
 };
 
 const SoAd_SocketRouteType           socket_route_3 = {
@@ -334,6 +549,7 @@ const SoAd_SoConConfigType           socket_group_1_conn_2 = {
     .group  = SOCKET_GRP1,
     .remote = (const TcpIp_SockAddrType*)&socket_remote_any_v4,
     .socket_route_id  = SOCKET_ROUTE1,
+    .buffer_quota     = 128u,
 };
 
 const SoAd_SoConConfigType           socket_group_2_conn_1 = {
@@ -354,20 +570,77 @@ const SoAd_SoConConfigType           socket_group_3_conn_1 = {
     .socket_route_id  = SOCKET_ROUTE2,
 };
 
+const SoAd_SoConConfigType           socket_group_4_conn_1 = {
+    .group  = SOCKET_GRP4,
+    .remote = (const TcpIp_SockAddrType*)&socket_remote_loopback_v4,
+    .socket_route_id  = SOCKET_ROUTE3,
+};
+
 const SoAd_PduRouteType              pdu_route_1 = {
         .pdu_id = 0u,
         .upper  = &suite_tptx,
+        .upper_if = &suite_iftx,
+        .priority = 1u,
         .destination = {
                 .header_id  = SOAD_PDUHEADERID_INVALID,
                 .connection = SOCKET_GRP1_CON1,
+                .routing_groups = 1u << ROUTING_GRP1,
+        },
+};
+
+const SoAd_PduRouteType              pdu_route_2 = {
+        .pdu_id = 1u,
+        .upper  = &suite_tptx,
+        .priority = 0u,
+        .destination = {
+                .header_id  = SOAD_PDUHEADERID_INVALID,
+                .connection = SOCKET_GRP1_CON2,
         },
 };
 
+const SoAd_BufferClassType           buffer_class_1 = {
+        .size  = 64u,
+        .count = 4u,
+};
+
+const SoAd_BufferClassType           buffer_class_2 = {
+        .size  = 256u,
+        .count = 2u,
+};
+
+const SoAd_AcceptFilterType          accept_filter_low_v4 = {
+    .group    = SOCKET_GRP2,
+    .domain   = TCPIP_AF_INET,
+    .addr     = { 0x00000000u },
+    .prefix   = 28u,
+    .port_min = 0u,
+    .port_max = 0xffffu,
+};
+
+const SoAd_AcceptFilterType          accept_filter_lan_v4 = {
+    .group    = SOCKET_GRP2,
+    .domain   = TCPIP_AF_INET,
+    .addr     = { 0xc0a80000u },
+    .prefix   = 16u,
+    .port_min = 100u,
+    .port_max = 200u,
+};
+
+const SoAd_AcceptFilterType          accept_filter_doc_v6 = {
+    .group    = SOCKET_GRP2,
+    .domain   = TCPIP_AF_INET6,
+    .addr     = { 0x20010db8u, 0u, 0u, 0u },
+    .prefix   = 32u,
+    .port_min = 0u,
+    .port_max = 0xffffu,
+};
+
 const SoAd_ConfigType config = {
     .groups = {
         [SOCKET_GRP1] = &socket_group_1,
         [SOCKET_GRP2] = &socket_group_2,
         [SOCKET_GRP3] = &socket_group_3,
+        [SOCKET_GRP4] = &socket_group_4,
     },
 
     .connections = {
@@ -376,6 +649,7 @@ const SoAd_ConfigType config = {
         [SOCKET_GRP2_CON1] = &socket_group_2_conn_1,
         [SOCKET_GRP2_CON2] = &socket_group_2_conn_2,
         [SOCKET_GRP3_CON1] = &socket_group_3_conn_1,
+        [SOCKET_GRP4_CON1] = &socket_group_4_conn_1,
     },
 
     .socket_routes     = {
@@ -386,6 +660,25 @@ const SoAd_ConfigType config = {
 
     .pdu_routes        = {
         &pdu_route_1,
+        &pdu_route_2,
+    },
+
+    .buffer_classes    = {
+        &buffer_class_1,
+        &buffer_class_2,
+    },
+
+    .accept_filters    = {
+        &accept_filter_low_v4,
+        &accept_filter_lan_v4,
+        &accept_filter_doc_v6,
+    },
+
+    .routing_init      = (1u << ROUTING_GRP1) | (1u << ROUTING_GRP2),
+
+    .mode_chg          = {
+        &suite_mode_chg_sd,
+        &suite_mode_chg_bswm,
     },
 };
 
@@ -394,6 +687,10 @@ int suite_init(void)
 {
     suite_state.socket_id  = 1u;
     suite_state.port_index = 1024u;
+    suite_state.rx_space   = (PduLengthType)0xffffu;
+    suite_state.fail_socket = FALSE;
+    suite_state.trigger_calls = 0u;
+    memset(suite_state.mode_chg, 0, sizeof(suite_state.mode_chg));
     memset(suite_state.sockets, 0, sizeof(suite_state.sockets));
     memset(suite_state.rxpdu  , 0, sizeof(suite_state.rxpdu));
 
@@ -462,52 +759,99 @@ void suite_test_wildcard_v6()
     CU_ASSERT_FALSE(SoAd_SockAddrWildcard((TcpIp_SockAddrType*)&inet));
 }
 
+void suite_test_wildcard_match_v6()
+{
+    TcpIp_SockAddrInet6Type mask;
+    TcpIp_SockAddrInet6Type inet;
+
+    mask.domain  = TCPIP_AF_INET6;
+    mask.addr[0] = 0x20010db8u;
+    mask.addr[1] = 0u;
+    mask.addr[2] = 0u;
+    mask.addr[3] = 1u;
+    mask.port    = TCPIP_PORT_ANY;
+
+    inet         = mask;
+    inet.port    = 1u;
+    CU_ASSERT_TRUE(SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&mask, (TcpIp_SockAddrType*)&inet));
+
+    inet.addr[3] = 2u;
+    CU_ASSERT_FALSE(SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&mask, (TcpIp_SockAddrType*)&inet));
+
+    mask.addr[0] = TCPIP_IPADDR_ANY;
+    mask.addr[3] = TCPIP_IPADDR_ANY;
+    CU_ASSERT_TRUE(SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&mask, (TcpIp_SockAddrType*)&inet));
+}
+
+void suite_test_wildcard_match_domain()
+{
+    TcpIp_SockAddrInetType  mask;
+    TcpIp_SockAddrInet6Type inet;
+
+    mask.domain  = TCPIP_AF_INET;
+    mask.addr[0] = TCPIP_IPADDR_ANY;
+    mask.port    = TCPIP_PORT_ANY;
+
+    inet.domain  = TCPIP_AF_INET6;
+    inet.addr[0] = 0x20010db8u;
+    inet.addr[1] = 0u;
+    inet.addr[2] = 0u;
+    inet.addr[3] = 1u;
+    inet.port    = 1u;
+
+    /* a wildcard only covers addresses of its own domain */
+    CU_ASSERT_FALSE(SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&mask, (TcpIp_SockAddrType*)&inet));
+    CU_ASSERT_FALSE(SoAd_SockAddrWildcardMatch((TcpIp_SockAddrType*)&inet, (TcpIp_SockAddrType*)&mask));
+}
+
 void main_add_generic_suite(CU_pSuite suite)
 {
     CU_add_test(suite, "wildcard_v4"             , suite_test_wildcard_v4);
     CU_add_test(suite, "wildcard_v6"             , suite_test_wildcard_v6);
+    CU_add_test(suite, "wildcard_match_v6"       , suite_test_wildcard_match_v6);
+    CU_add_test(suite, "wildcard_match_domain"   , suite_test_wildcard_match_domain);
 }
 
 void main_test_mainfunction_open()
 {
     struct suite_socket_state* socket_state;
 
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP1_CON1].state, SOAD_SOCON_OFFLINE);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP1_CON2].state, SOAD_SOCON_OFFLINE);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
     SoAd_MainFunction();
 
     /* TCP listen socket should be bound and listening */
-    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_SoGrpStatus[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
-    socket_state = &suite_state.sockets[SoAd_SoGrpStatus[SOCKET_GRP1].socket_id];
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+    socket_state = &suite_state.sockets[SoAd_Instance->groups[SOCKET_GRP1].socket_id];
     CU_ASSERT_EQUAL(socket_state->retrieve    , TRUE);
     CU_ASSERT_EQUAL(socket_state->bound       , TRUE);
     CU_ASSERT_EQUAL(socket_state->listen      , TRUE);
     CU_ASSERT_EQUAL(socket_state->connect     , FALSE);
 
     /* TCP extra sockets should be just waiting to connect */
-    CU_ASSERT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP1_CON1].socket_id, TCPIP_SOCKETID_INVALID);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP1_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_RECONNECT);
 
-    CU_ASSERT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP1_CON2].socket_id, TCPIP_SOCKETID_INVALID);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP1_CON2].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].state, SOAD_SOCON_RECONNECT);
 
     /* UDP group socket should be bound, but not listening or connected */
-    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_SoGrpStatus[SOCKET_GRP2].socket_id, TCPIP_SOCKETID_INVALID);
-    socket_state = &suite_state.sockets[SoAd_SoGrpStatus[SOCKET_GRP2].socket_id];
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->groups[SOCKET_GRP2].socket_id, TCPIP_SOCKETID_INVALID);
+    socket_state = &suite_state.sockets[SoAd_Instance->groups[SOCKET_GRP2].socket_id];
     CU_ASSERT_EQUAL(socket_state->retrieve    , TRUE);
     CU_ASSERT_EQUAL(socket_state->bound       , TRUE);
     CU_ASSERT_EQUAL(socket_state->listen      , FALSE);
     CU_ASSERT_EQUAL(socket_state->connect     , FALSE);
 
-    CU_ASSERT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP2_CON1].socket_id, TCPIP_SOCKETID_INVALID);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
 
     /* TCP connect socket should be waiting for a connection */
-    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP3_CON1].socket_id, TCPIP_SOCKETID_INVALID);
-    socket_state = &suite_state.sockets[SoAd_SoConStatus[SOCKET_GRP3_CON1].socket_id];
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id, TCPIP_SOCKETID_INVALID);
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id];
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
     CU_ASSERT_EQUAL(socket_state->connect     , TRUE);
 }
 
@@ -518,20 +862,20 @@ void main_test_mainfunction_accept(SoAd_SoGrpIdType id_grp, SoAd_SoConIdType id_
     inet.addr[0] = 1;
     inet.port    = 1;
 
-    CU_ASSERT_EQUAL(SoAd_TcpAccepted(SoAd_SoGrpStatus[id_grp].socket_id
+    CU_ASSERT_EQUAL(SoAd_TcpAccepted(SoAd_Instance->groups[id_grp].socket_id
                                    , ++suite_state.socket_id
                                    , (TcpIp_SockAddrType*)&inet)
                   , E_OK);
-    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_SoConStatus[id_con].socket_id
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[id_con].socket_id
                            , TCPIP_SOCKETID_INVALID);
 
     struct suite_socket_state* socket_state;
-    socket_state = &suite_state.sockets[SoAd_SoConStatus[id_con].socket_id];
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[id_con].socket_id];
     CU_ASSERT_EQUAL(socket_state->retrieve    , FALSE);
     CU_ASSERT_EQUAL(socket_state->bound       , FALSE);
     CU_ASSERT_EQUAL(socket_state->listen      , FALSE);
     CU_ASSERT_EQUAL(socket_state->connect     , FALSE);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[id_con].state
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[id_con].state
                  , SOAD_SOCON_ONLINE);
 }
 
@@ -553,18 +897,18 @@ void main_test_mainfunction_connect(SoAd_SoGrpIdType id_grp, SoAd_SoConIdType id
     inet.addr[0] = 1;
     inet.port    = 1;
 
-    SoAd_TcpConnected(SoAd_SoConStatus[id_con].socket_id);
+    SoAd_TcpConnected(SoAd_Instance->connections[id_con].socket_id);
 
-    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_SoConStatus[id_con].socket_id
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[id_con].socket_id
                            , TCPIP_SOCKETID_INVALID);
 
     struct suite_socket_state* socket_state;
-    socket_state = &suite_state.sockets[SoAd_SoConStatus[id_con].socket_id];
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[id_con].socket_id];
     CU_ASSERT_EQUAL(socket_state->retrieve    , FALSE);
     CU_ASSERT_EQUAL(socket_state->bound       , FALSE);
     CU_ASSERT_EQUAL(socket_state->listen      , FALSE);
     CU_ASSERT_EQUAL(socket_state->connect     , FALSE);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[id_con].state
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[id_con].state
                  , SOAD_SOCON_ONLINE);
 }
 
@@ -583,9 +927,9 @@ void main_test_mainfunction_receive(SoAd_SoConIdType id_grp, SoAd_SoConIdType id
     route = config.socket_routes[config.connections[id_con]->socket_route_id];
     prev  = suite_state.rxpdu[route->destination.pdu].rx_count;
 
-    socket_id = SoAd_SoConStatus[id_con].socket_id;
+    socket_id = SoAd_Instance->connections[id_con].socket_id;
     if (socket_id == TCPIP_SOCKETID_INVALID) {
-        socket_id = SoAd_SoGrpStatus[id_grp].socket_id;
+        socket_id = SoAd_Instance->groups[id_grp].socket_id;
     }
 
     SoAd_RxIndication(socket_id
@@ -598,16 +942,16 @@ void main_test_mainfunction_receive(SoAd_SoConIdType id_grp, SoAd_SoConIdType id
 
 void main_test_mainfunction_receive_udp_1()
 {
-    CU_ASSERT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
     main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
 }
 
 void main_test_mainfunction_receive_udp_2()
 {
-    CU_ASSERT_EQUAL_FATAL(SoAd_SoConStatus[SOCKET_GRP2_CON2].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_RECONNECT);
     main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON2);
-    CU_ASSERT_EQUAL(SoAd_SoConStatus[SOCKET_GRP2_CON2].state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_ONLINE);
 }
 
 
@@ -633,20 +977,2398 @@ void main_add_mainfunction_suite(CU_pSuite suite)
     CU_add_test(suite, "receive_tcp_2"     , main_test_mainfunction_receive_tcp_2);
 }
 
-int main(void)
+void main_test_buffer_alloc(void)
 {
-    CU_pSuite suite = NULL;
+    SoAd_BufferIdType id[4];
+
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 10u , &id[0]), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Size(SoAd_Instance, id[0]), 64u);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 100u, &id[1]), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Size(SoAd_Instance, id[1]), 256u);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 100u, &id[2]), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 100u, &id[3]), E_NOT_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 300u, &id[3]), E_NOT_OK);
+    CU_ASSERT_NOT_EQUAL(SoAd_Buffer_Data(SoAd_Instance, id[0]), SoAd_Buffer_Data(SoAd_Instance, id[1]));
+    CU_ASSERT_NOT_EQUAL(SoAd_Buffer_Data(SoAd_Instance, id[1]), SoAd_Buffer_Data(SoAd_Instance, id[2]));
+
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.con_used[SOCKET_GRP1_CON1], 64u + 256u + 256u);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.grp_used[SOCKET_GRP1]     , 64u + 256u + 256u);
+
+    SoAd_Buffer_Free(SoAd_Instance, id[1]);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 100u, &id[3]), E_OK);
+    CU_ASSERT_EQUAL(id[3], id[1]);
+
+    SoAd_Buffer_Free(SoAd_Instance, id[0]);
+    SoAd_Buffer_Free(SoAd_Instance, id[2]);
+    SoAd_Buffer_Free(SoAd_Instance, id[3]);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.con_used[SOCKET_GRP1_CON1]      , 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.con_high_water[SOCKET_GRP1_CON1], 64u + 256u + 256u);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.classes[1].used      , 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.classes[1].high_water, 2u);
+}
 
-    /* initialize the CUnit test registry */
-    if (CUE_SUCCESS != CU_initialize_registry())
-      return CU_get_error();
+void main_test_buffer_quota(void)
+{
+    SoAd_BufferIdType id[3];
 
-    /* add a suite to the registry */
-    suite = CU_add_suite("Suite_Generic", suite_init, suite_clean);
-    main_add_generic_suite(suite);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON2, 10u, &id[0]), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON2, 10u, &id[1]), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON2, 10u, &id[2]), E_NOT_OK);
 
-    suite = CU_add_suite("Suite_MainFunction", suite_init, suite_clean);
-    main_add_mainfunction_suite(suite);
+    /* quota is per connection, so others may still allocate */
+    CU_ASSERT_EQUAL(SoAd_Buffer_Alloc(SoAd_Instance, SOCKET_GRP1_CON1, 10u, &id[2]), E_OK);
+
+    SoAd_Buffer_Free(SoAd_Instance, id[0]);
+    SoAd_Buffer_Free(SoAd_Instance, id[1]);
+    SoAd_Buffer_Free(SoAd_Instance, id[2]);
+}
+
+void main_test_buffer_receive(void)
+{
+    uint8                       data[100];
+    const SoAd_SocketRouteType* route;
+    uint32                      prev;
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept(SOCKET_GRP1, SOCKET_GRP1_CON1);
+
+    route = config.socket_routes[config.connections[SOCKET_GRP1_CON1]->socket_route_id];
+    prev  = suite_state.rxpdu[route->destination.pdu].rx_count;
+
+    /* upper layer can only take part, rest is kept in a pool buffer */
+    suite_state.rx_space = 40u;
+    SoAd_RxIndication(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id
+                    , (TcpIp_SockAddrType*)&socket_remote_loopback_v4
+                    , data
+                    , sizeof(data));
+    CU_ASSERT_EQUAL(suite_state.rxpdu[route->destination.pdu].rx_count, prev + 40u);
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_buffer, SOAD_BUFFERID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.buffers[SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_buffer].length, 60u);
+
+    /* remainder is forwarded once upper layer has space */
+    suite_state.rx_space = (PduLengthType)0xffffu;
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[route->destination.pdu].rx_count, prev + sizeof(data));
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_buffer, SOAD_BUFFERID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->buffer_pool.con_used[SOCKET_GRP1_CON1], 0u);
+}
+
+void main_add_buffer_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "alloc"             , main_test_buffer_alloc);
+    CU_add_test(suite, "quota"             , main_test_buffer_quota);
+    CU_add_test(suite, "receive"           , main_test_buffer_receive);
+}
+
+void main_test_timer_wheel(void)
+{
+    const SoAd_TimerIdType near = SOAD_TIMER_ID(SOCKET_GRP1_CON1, SOAD_TIMER_TPTX);
+    const SoAd_TimerIdType mid  = SOAD_TIMER_ID(SOCKET_GRP1_CON2, SOAD_TIMER_TPTX);
+    const SoAd_TimerIdType far  = SOAD_TIMER_ID(SOCKET_GRP2_CON1, SOAD_TIMER_TPTX);
+    const SoAd_TimerIdType gone = SOAD_TIMER_ID(SOCKET_GRP2_CON2, SOAD_TIMER_TPTX);
+    uint32                 tick;
+
+    SoAd_Timer_Arm(SoAd_Instance, near, 3u);
+    SoAd_Timer_Arm(SoAd_Instance, mid , 100u);
+    SoAd_Timer_Arm(SoAd_Instance, far , 5000u);
+    SoAd_Timer_Arm(SoAd_Instance, gone, 50u);
+    SoAd_Timer_Cancel(SoAd_Instance, gone);
+    CU_ASSERT_FALSE(SoAd_Timer_Active(SoAd_Instance, gone));
+
+    for (tick = 1u; tick <= 5000u; ++tick) {
+        SoAd_Timer_Tick(SoAd_Instance);
+        CU_ASSERT_EQUAL(SoAd_Timer_Active(SoAd_Instance, near), tick < 3u);
+        CU_ASSERT_EQUAL(SoAd_Timer_Active(SoAd_Instance, mid) , tick < 100u);
+        CU_ASSERT_EQUAL(SoAd_Timer_Active(SoAd_Instance, far) , tick < 5000u);
+    }
+    CU_ASSERT_FALSE(SoAd_Timer_Active(SoAd_Instance, gone));
+
+    /* re-arming moves the expiry */
+    SoAd_Timer_Arm(SoAd_Instance, near, 2u);
+    SoAd_Timer_Tick(SoAd_Instance);
+    SoAd_Timer_Arm(SoAd_Instance, near, 2u);
+    SoAd_Timer_Tick(SoAd_Instance);
+    CU_ASSERT_TRUE(SoAd_Timer_Active(SoAd_Instance, near));
+    SoAd_Timer_Tick(SoAd_Instance);
+    CU_ASSERT_FALSE(SoAd_Timer_Active(SoAd_Instance, near));
+}
+
+void main_test_timer_alive(void)
+{
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive_udp_1();
+    CU_ASSERT_FALSE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON1].remote));
+
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+
+    /* reception restarts supervision */
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_TRUE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON1].remote));
+}
+
+void main_test_retry_open(void)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[SOCKET_GRP3_CON1];
+    static const uint16         delay[] = { 2u, 2u, 4u, 4u, 4u, 4u, 8u };
+    uint8                       index;
+
+    suite_state.fail_socket = TRUE;
+    for (index = 0u; index < sizeof(delay) / sizeof(delay[0]); ++index) {
+        SoAd_MainFunction();
+        CU_ASSERT_EQUAL(status->retry_delay, delay[index]);
+        CU_ASSERT_TRUE(SoAd_Timer_Active(SoAd_Instance, SOAD_TIMER_ID(SOCKET_GRP3_CON1, SOAD_TIMER_RETRY)));
+    }
+
+    /* delay is capped */
+    for (index = 0u; index < 16u; ++index) {
+        SoAd_MainFunction();
+    }
+    CU_ASSERT_EQUAL(status->retry_delay, 8u);
+
+    suite_state.fail_socket = FALSE;
+    for (index = 0u; index < 8u; ++index) {
+        SoAd_MainFunction();
+    }
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_NOT_EQUAL(status->socket_id, TCPIP_SOCKETID_INVALID);
+}
+
+void main_test_retry_connect(void)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[SOCKET_GRP3_CON1];
+
+    CU_ASSERT_EQUAL_FATAL(status->state, SOAD_SOCON_RECONNECT);
+    SoAd_TcpIpEvent(status->socket_id, TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_TRUE(SoAd_Timer_Active(SoAd_Instance, SOAD_TIMER_ID(SOCKET_GRP3_CON1, SOAD_TIMER_RETRY)));
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_OFFLINE);
+}
+
+void main_add_timer_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "wheel"             , main_test_timer_wheel);
+    CU_add_test(suite, "alive"             , main_test_timer_alive);
+}
+
+void main_add_retry_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "open"              , main_test_retry_open);
+    CU_add_test(suite, "connect"           , main_test_retry_connect);
+}
+
+void main_test_localaddr_wait(void)
+{
+    CU_ASSERT_EQUAL(SoAd_Instance->localaddrs[SOCKET_LOCALADDR].state, TCPIP_IPADDR_STATE_UNASSIGNED);
+
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP4_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_TRUE (SoAd_Instance->connections[SOCKET_GRP4_CON1].addr_waiting);
+    CU_ASSERT_EQUAL(SoAd_Instance->localaddrs[SOCKET_LOCALADDR].waiting, SOCKET_GRP4_CON1);
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP4].socket_id, TCPIP_SOCKETID_INVALID);
+
+    /* other groups are not held back */
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+}
+
+void main_test_localaddr_assign(void)
+{
+    SoAd_LocalIpAddrAssignmentChg(SOCKET_LOCALADDR, TCPIP_IPADDR_STATE_ASSIGNED);
+    CU_ASSERT_FALSE(SoAd_Instance->connections[SOCKET_GRP4_CON1].addr_waiting);
+    CU_ASSERT_EQUAL(SoAd_Instance->localaddrs[SOCKET_LOCALADDR].waiting, SOAD_SOCONID_INVALID);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP4_CON1].state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_NOT_EQUAL(SoAd_Instance->groups[SOCKET_GRP4].socket_id, TCPIP_SOCKETID_INVALID);
+}
+
+void main_test_localaddr_lost(void)
+{
+    TcpIp_SocketIdType socket_id = SoAd_Instance->groups[SOCKET_GRP4].socket_id;
+
+    SoAd_LocalIpAddrAssignmentChg(SOCKET_LOCALADDR, TCPIP_IPADDR_STATE_UNASSIGNED);
+    CU_ASSERT_FALSE(suite_state.sockets[socket_id].bound);
+
+    /* socket is kept until TcpIp reports it closed */
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP4].socket_id, socket_id);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP4_CON1].state, SOAD_SOCON_ONLINE);
+
+    SoAd_TcpIpEvent(socket_id, TCPIP_UDP_CLOSED);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP4_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP4].socket_id, TCPIP_SOCKETID_INVALID);
+
+    SoAd_MainFunction();
+    CU_ASSERT_TRUE(SoAd_Instance->connections[SOCKET_GRP4_CON1].addr_waiting);
+}
+
+void main_test_reuse_prepare(void)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[SOCKET_GRP3_CON1];
+
+    main_test_mainfunction_open();
+    SoAd_TcpConnected(status->socket_id);
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_EQUAL(status->socket_spare, TCPIP_SOCKETID_INVALID);
+
+    SoAd_MainFunction();
+    CU_ASSERT_NOT_EQUAL_FATAL(status->socket_spare, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_TRUE (suite_state.sockets[status->socket_spare].bound);
+    CU_ASSERT_FALSE(suite_state.sockets[status->socket_spare].connect);
+}
+
+void main_test_reuse_reconnect(void)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[SOCKET_GRP3_CON1];
+    TcpIp_SocketIdType          spare  = status->socket_spare;
+    TcpIp_SocketIdType          last   = suite_state.socket_id;
+
+    SoAd_TcpIpEvent(status->socket_id, TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_OFFLINE);
+
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+
+    /* reconnect is done on the spare socket, without a new one from TcpIp */
+    CU_ASSERT_EQUAL(status->state    , SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(status->socket_id, spare);
+    CU_ASSERT_EQUAL(status->socket_spare, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_TRUE (suite_state.sockets[spare].connect);
+    CU_ASSERT_EQUAL(suite_state.socket_id, last);
+}
+
+void main_test_reuse_udp(void)
+{
+    SoAd_ConfigType             reuse_config = config;
+    SoAd_SoGrpConfigType        reuse_grp    = socket_group_2;
+    const SoAd_SoConStatusType* status       = &SoAd_Instance->connections[SOCKET_GRP2_CON1];
+    TcpIp_SockAddrInetType      remote       = socket_remote_loopback_v4;
+    uint8                       data[4]      = {0};
+    TcpIp_SocketIdType          spare;
+
+    reuse_grp.initiate    = TRUE;
+    reuse_grp.automatic   = FALSE;
+    reuse_grp.keep_socket = TRUE;
+    reuse_config.groups[SOCKET_GRP2] = &reuse_grp;
+    SoAd_Init(&reuse_config);
+
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP2_CON1), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_NOT_EQUAL_FATAL(status->socket_id, TCPIP_SOCKETID_INVALID);
+
+    /* closed udp connection parks its bound socket */
+    spare = status->socket_id;
+    CU_ASSERT_EQUAL(SoAd_CloseSoCon(SOCKET_GRP2_CON1, FALSE), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(status->state       , SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(status->socket_spare, spare);
+
+    /* datagrams and events on the parked socket are known, no DET */
+    SoAd_RxIndication(spare, (const TcpIp_SockAddrType*)&remote, data, sizeof(data));
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_OFFLINE);
+
+    SoAd_TcpIpEvent(spare, TCPIP_UDP_CLOSED);
+    CU_ASSERT_EQUAL(status->socket_spare, TCPIP_SOCKETID_INVALID);
+
+    /* the next open takes a new socket */
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP2_CON1), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_NOT_EQUAL(status->socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_NOT_EQUAL(status->socket_id, spare);
+
+    SoAd_Init(&config);
+}
+
+void main_test_measurement_counters(void)
+{
+    const SoAd_SoConCountersType* counters = &SoAd_Instance->measurement[0].connections[SOCKET_GRP1_CON1];
+    uint8                         data[10] = {0};
+    PduInfoType                   info;
+
+    info.SduDataPtr = data;
+    info.SduLength  = sizeof(data);
+
+    /* transmit while offline is counted as dropped */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_NOT_OK);
+    CU_ASSERT_EQUAL(counters->tx_drop_offline, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].pdu_routes[0].tx_dropped, 1u);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    main_test_mainfunction_receive_tcp_1();
+    CU_ASSERT_EQUAL(counters->rx_pdus , 1u);
+    CU_ASSERT_EQUAL(counters->rx_bytes, 100u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].socket_routes[SOCKET_ROUTE1].rx_bytes, 100u);
+    CU_ASSERT_NOT_EQUAL(counters->state_changes, 0u);
+
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(counters->tx_pdus , 1u);
+    CU_ASSERT_EQUAL(counters->tx_bytes, sizeof(data));
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].pdu_routes[0].tx_bytes, sizeof(data));
+}
+
+void main_test_measurement_reset(void)
+{
+    SoAd_MeasurementDataType snapshot;
+    uint32                   value = 0xffffffffu;
+
+    SoAd_Instance->measurement[0].drop_udp = 3u;
+    CU_ASSERT_EQUAL(SoAd_GetAndResetMeasurementData(SOAD_MEAS_DROP_UDP, TRUE, &value), E_OK);
+    CU_ASSERT_EQUAL(value, 3u);
+    CU_ASSERT_EQUAL(SoAd_GetAndResetMeasurementData(SOAD_MEAS_DROP_UDP, FALSE, &value), E_OK);
+    CU_ASSERT_EQUAL(value, 0u);
+
+    CU_ASSERT_EQUAL(SoAd_GetMeasurementSnapshot(&snapshot, FALSE), E_OK);
+    CU_ASSERT_EQUAL(snapshot.connections[SOCKET_GRP1_CON1].tx_pdus, 1u);
+
+    CU_ASSERT_EQUAL(SoAd_GetAndResetMeasurementData(SOAD_MEAS_ALL, TRUE, NULL_PTR), E_OK);
+    CU_ASSERT_EQUAL(SoAd_GetMeasurementSnapshot(&snapshot, FALSE), E_OK);
+    CU_ASSERT_EQUAL(snapshot.connections[SOCKET_GRP1_CON1].tx_pdus, 0u);
+}
+
+/**
+ * @brief Host side dump of a drained trace ring into a trace file, read back for checking
+ */
+static uint16 main_trace_dump(uint32* lost)
+{
+    SoAd_TraceEventType      events[SOAD_CFG_TRACE_SIZE];
+    uint16                   count = SOAD_CFG_TRACE_SIZE;
+    uint16                   index;
+    SoAd_TraceFileHeaderType header;
+    SoAd_TraceFileRecordType record;
+    FILE*                    file;
+
+    CU_ASSERT_EQUAL_FATAL(SoAd_GetTraceEvents(0u, events, &count, lost), E_OK);
+
+    file = tmpfile();
+    CU_ASSERT_PTR_NOT_NULL_FATAL(file);
+
+    header.core = 0u;
+    header.lost = *lost;
+    CU_ASSERT_EQUAL(SoAd_TraceFile_WriteHeader(file, &header), 0);
+    for (index = 0u; index < count; ++index) {
+        record.timestamp  = events[index].timestamp;
+        record.point      = events[index].point;
+        record.result     = events[index].result;
+        record.connection = events[index].connection;
+        record.route      = events[index].route;
+        record.length     = events[index].length;
+        CU_ASSERT_EQUAL(SoAd_TraceFile_WriteRecord(file, &record), 0);
+    }
+
+    rewind(file);
+    CU_ASSERT_EQUAL(SoAd_TraceFile_ReadHeader(file, &header), 0);
+    CU_ASSERT_EQUAL(header.lost, *lost);
+    for (index = 0u; index < count; ++index) {
+        CU_ASSERT_EQUAL_FATAL(SoAd_TraceFile_ReadRecord(file, &record), 0);
+        CU_ASSERT_EQUAL(record.timestamp , events[index].timestamp);
+        CU_ASSERT_EQUAL(record.point     , events[index].point);
+        CU_ASSERT_EQUAL(record.connection, events[index].connection);
+        CU_ASSERT_EQUAL(record.length    , events[index].length);
+    }
+    CU_ASSERT_EQUAL(SoAd_TraceFile_ReadRecord(file, &record), 1);
+    fclose(file);
+    return count;
+}
+
+void main_test_trace_events(void)
+{
+    SoAd_TraceEventType events[SOAD_CFG_TRACE_SIZE];
+    uint16              count = SOAD_CFG_TRACE_SIZE;
+    uint32              lost;
+    uint8               data[10] = {0};
+    PduInfoType         info;
+
+    info.SduDataPtr = data;
+    info.SduLength  = sizeof(data);
+
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_NOT_OK);
+
+    CU_ASSERT_EQUAL(SoAd_GetTraceEvents(0u, events, &count, &lost), E_OK);
+    CU_ASSERT_EQUAL_FATAL(count, 2u);
+    CU_ASSERT_EQUAL(lost, 0u);
+    CU_ASSERT_EQUAL(events[0].point     , SOAD_TRACE_IFTRANSMIT);
+    CU_ASSERT_EQUAL(events[1].point     , SOAD_TRACE_IFTRANSMIT | SOAD_TRACE_FLAG_EXIT);
+    CU_ASSERT_EQUAL(events[1].connection, SOCKET_GRP1_CON1);
+    CU_ASSERT_EQUAL(events[1].length    , sizeof(data));
+    CU_ASSERT_EQUAL(events[1].result    , E_NOT_OK);
+
+    /* ring is drained */
+    count = SOAD_CFG_TRACE_SIZE;
+    CU_ASSERT_EQUAL(SoAd_GetTraceEvents(0u, events, &count, &lost), E_OK);
+    CU_ASSERT_EQUAL(count, 0u);
+}
+
+void main_test_trace_overflow(void)
+{
+    uint32 lost;
+    uint8  index;
+
+    /* main functions with state changes overrun the small ring */
+    main_test_mainfunction_open();
+    for (index = 0u; index < SOAD_CFG_TRACE_SIZE; ++index) {
+        SoAd_MainFunction();
+    }
+
+    CU_ASSERT_EQUAL(main_trace_dump(&lost), SOAD_CFG_TRACE_SIZE);
+    CU_ASSERT_NOT_EQUAL(lost, 0u);
+}
+
+void main_test_trace_histogram(void)
+{
+    SoAd_TraceHistogramType histogram;
+    uint32                  total = 0u;
+    uint8                   bin;
+
+    CU_ASSERT_EQUAL(SoAd_GetTraceHistogram(SOAD_TRACE_MAINFUNCTION, &histogram, TRUE), E_OK);
+    for (bin = 0u; bin < 32u; ++bin) {
+        total += histogram.bins[bin];
+    }
+    CU_ASSERT(total >= SOAD_CFG_TRACE_SIZE);
+    CU_ASSERT_EQUAL(histogram.bins[0], 0u);
+
+    CU_ASSERT_EQUAL(SoAd_GetTraceHistogram(SOAD_TRACE_MAINFUNCTION, &histogram, FALSE), E_OK);
+    CU_ASSERT_EQUAL(histogram.bins[1], 0u);
+}
+
+void main_add_trace_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "events"            , main_test_trace_events);
+    CU_add_test(suite, "overflow"          , main_test_trace_overflow);
+    CU_add_test(suite, "histogram"         , main_test_trace_histogram);
+}
+
+void main_test_budget_units(void)
+{
+    static SoAd_ConfigType     budget_config;
+    SoAd_MainFunctionStatsType stats;
+
+    budget_config             = config;
+    budget_config.main_budget = 2u;
+    SoAd_Init(&budget_config);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 2u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 4u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+
+    /* third call resumes with the connections not yet visited */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
+
+    CU_ASSERT_EQUAL(SoAd_GetMainFunctionStats(&stats, TRUE), E_OK);
+    CU_ASSERT_EQUAL(stats.calls    , 3u);
+    CU_ASSERT_EQUAL(stats.exhausted, 3u);
+    CU_ASSERT(stats.min <= stats.avg);
+    CU_ASSERT(stats.avg <= stats.max);
+}
+
+void main_test_budget_cycles(void)
+{
+    static SoAd_ConfigType     budget_config;
+    SoAd_MainFunctionStatsType stats;
+
+    /* every timestamp read advances one tick, so one unit fits the budget */
+    budget_config             = config;
+    budget_config.main_cycles = 1u;
+    SoAd_Init(&budget_config);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 1u);
+
+    CU_ASSERT_EQUAL(SoAd_GetMainFunctionStats(&stats, FALSE), E_OK);
+    CU_ASSERT_EQUAL(stats.calls    , 1u);
+    CU_ASSERT_EQUAL(stats.exhausted, 1u);
+}
+
+void main_test_budget_unlimited(void)
+{
+    SoAd_MainFunctionStatsType stats;
+
+    SoAd_Init(&config);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
+
+    CU_ASSERT_EQUAL(SoAd_GetMainFunctionStats(&stats, FALSE), E_OK);
+    CU_ASSERT_EQUAL(stats.exhausted, 0u);
+}
+
+void main_add_budget_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "units"             , main_test_budget_units);
+    CU_add_test(suite, "cycles"            , main_test_budget_cycles);
+    CU_add_test(suite, "unlimited"         , main_test_budget_unlimited);
+}
+
+void main_test_window_coalesce(void)
+{
+    struct suite_socket_state* socket_state;
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id];
+
+    /* below threshold nothing is reported yet */
+    main_test_mainfunction_receive_tcp_1();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_unacked, 100u);
+
+    /* crossing it reports everything consumed so far in one go */
+    main_test_mainfunction_receive_tcp_1();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 1u);
+    CU_ASSERT_EQUAL(socket_state->received, 200u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_unacked, 0u);
+}
+
+void main_test_window_mainfunction(void)
+{
+    struct suite_socket_state* socket_state;
+
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id];
+
+    main_test_mainfunction_receive_tcp_1();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 1u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 2u);
+    CU_ASSERT_EQUAL(socket_state->received, 300u);
+
+    /* nothing new consumed, nothing reported */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 2u);
+}
+
+void main_test_window_dropped(void)
+{
+    struct suite_socket_state* socket_state;
+    TcpIp_SockAddrInetType     inet;
+    uint8                      data[100];
+
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id];
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 1;
+    inet.port    = SOCKET_GRP1_CON1;
+
+    /* data the upper layer refused is gone, the window must still reopen */
+    suite_state.fail_rx = TRUE;
+    SoAd_RxIndication(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id
+                    , (TcpIp_SockAddrType*)&inet
+                    , data
+                    , sizeof(data));
+    suite_state.fail_rx = FALSE;
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].rx_unacked, 100u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(socket_state->received_calls, 3u);
+    CU_ASSERT_EQUAL(socket_state->received, 400u);
+}
+
+void main_add_window_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "coalesce"          , main_test_window_coalesce);
+    CU_add_test(suite, "mainfunction"      , main_test_window_mainfunction);
+    CU_add_test(suite, "dropped"           , main_test_window_dropped);
+}
+
+static void main_ratelimit_send(uint32 addr)
+{
+    TcpIp_SockAddrInetType inet;
+    uint8                  data[10] = {0};
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = addr;
+    inet.port    = 1u;
+
+    SoAd_RxIndication(SoAd_Instance->groups[SOCKET_GRP2].socket_id
+                    , (TcpIp_SockAddrType*)&inet
+                    , data
+                    , sizeof(data));
+}
+
+void main_test_ratelimit_flood(void)
+{
+    const uint32* rx_count = &suite_state.rxpdu[socket_route_2.destination.pdu].rx_count;
+    uint32        prev;
+    uint8         index;
+
+    main_test_mainfunction_open();
+    prev = *rx_count;
+
+    /* burst is accepted, the rest dropped before connection lookup */
+    for (index = 0u; index < 5u; ++index) {
+        main_ratelimit_send(10u);
+    }
+    CU_ASSERT_EQUAL(*rx_count, prev + 30u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].rx_rate_limited, 2u);
+
+    /* other peers are unaffected */
+    main_ratelimit_send(11u);
+    CU_ASSERT_EQUAL(*rx_count, prev + 40u);
+}
+
+void main_test_ratelimit_refill(void)
+{
+    const uint32* rx_count = &suite_state.rxpdu[socket_route_2.destination.pdu].rx_count;
+    uint32        prev     = *rx_count;
+
+    SoAd_MainFunction();
+    main_ratelimit_send(10u);
+    CU_ASSERT_EQUAL(*rx_count, prev);
+
+    SoAd_MainFunction();
+    main_ratelimit_send(10u);
+    main_ratelimit_send(10u);
+    CU_ASSERT_EQUAL(*rx_count, prev + 10u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].rx_rate_limited, 4u);
+}
+
+void main_test_ratelimit_period(void)
+{
+    SoAd_ConfigType      limit_config = config;
+    SoAd_SoGrpConfigType limit_grp    = socket_group_2;
+
+    /* a rate without a period can't be refilled */
+    limit_grp.rx_limit.period        = 0u;
+    limit_config.groups[SOCKET_GRP2] = &limit_grp;
+
+    suite_state.det_expected = 1u;
+    SoAd_Init(&limit_config);
+    CU_ASSERT_EQUAL(suite_state.det_expected, 0u);
+    CU_ASSERT_PTR_NULL(SoAd_Instance->config);
+}
+
+void main_test_ratelimit_overflow(void)
+{
+    SoAd_ConfigType          limit_config = config;
+    SoAd_SoGrpConfigType     limit_grp    = socket_group_2;
+    const uint32*            rx_count     = &suite_state.rxpdu[socket_route_2.destination.pdu].rx_count;
+    TcpIp_SockAddrInetType   inet;
+    SoAd_RateLimitEntryType* entry;
+    uint32                   prev;
+    uint8                    index;
+
+    limit_grp.rx_limit.rate          = 2u;
+    limit_grp.rx_limit.period        = 1u;
+    limit_grp.rx_limit.burst         = 3u;
+    limit_config.groups[SOCKET_GRP2] = &limit_grp;
+    SoAd_Init(&limit_config);
+    main_test_mainfunction_open();
+
+    for (index = 0u; index < 4u; ++index) {
+        main_ratelimit_send(12u);
+    }
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 12u;
+    inet.port    = 1u;
+    entry = SoAd_RateLimit_Find(SoAd_Instance, SOCKET_GRP2, (const TcpIp_SockAddrType*)&inet);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(entry);
+    CU_ASSERT_EQUAL(entry->tokens, 0u);
+
+    /* periods * rate wraps to 0 after a long idle time, must still refill to burst */
+    entry->refill = SoAd_Instance->timer_wheel.now - 0x80000000u;
+    prev = *rx_count;
+    main_ratelimit_send(12u);
+    CU_ASSERT_EQUAL(*rx_count, prev + 10u);
+    CU_ASSERT_EQUAL(entry->tokens, 2u);
+
+    SoAd_Init(&config);
+}
+
+void main_add_ratelimit_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "flood"             , main_test_ratelimit_flood);
+    CU_add_test(suite, "refill"            , main_test_ratelimit_refill);
+    CU_add_test(suite, "period"            , main_test_ratelimit_period);
+    CU_add_test(suite, "overflow"          , main_test_ratelimit_overflow);
+}
+
+void main_test_filter_match(void)
+{
+    TcpIp_SockAddrInetType  inet;
+    TcpIp_SockAddrInet6Type inet6;
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 0x0000000fu;
+    inet.port    = 1u;
+    CU_ASSERT_TRUE (SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet));
+
+    inet.addr[0] = 0x00000010u;
+    CU_ASSERT_FALSE(SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet));
+
+    /* prefix matches, port range decides */
+    inet.addr[0] = 0xc0a80101u;
+    inet.port    = 150u;
+    CU_ASSERT_TRUE (SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet));
+    inet.port    = 201u;
+    CU_ASSERT_FALSE(SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet));
+
+    /* filters are per group */
+    inet.port    = 150u;
+    CU_ASSERT_FALSE(SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP1, (TcpIp_SockAddrType*)&inet));
+
+    inet6.domain  = TCPIP_AF_INET6;
+    inet6.addr[0] = 0x20010db8u;
+    inet6.addr[1] = 0x12345678u;
+    inet6.addr[2] = 0u;
+    inet6.addr[3] = 1u;
+    inet6.port    = 1u;
+    CU_ASSERT_TRUE (SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet6));
+
+    inet6.addr[0] = 0x20010db9u;
+    CU_ASSERT_FALSE(SoAd_AcceptFilter_Match(SoAd_Instance, SOCKET_GRP2, (TcpIp_SockAddrType*)&inet6));
+}
+
+void main_test_filter_drop(void)
+{
+    const uint32* rx_count = &suite_state.rxpdu[socket_route_2.destination.pdu].rx_count;
+    uint32        prev;
+
+    main_test_mainfunction_open();
+    prev = *rx_count;
+
+    main_ratelimit_send(0x0a000001u);
+    CU_ASSERT_EQUAL(*rx_count, prev);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].rx_filtered, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+
+    main_ratelimit_send(1u);
+    CU_ASSERT_EQUAL(*rx_count, prev + 10u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+}
+
+void main_add_filter_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "match"             , main_test_filter_match);
+    CU_add_test(suite, "drop"              , main_test_filter_drop);
+}
+
+void main_test_remote_shared(void)
+{
+    SoAd_RemoteIdType id = SoAd_Instance->connections[SOCKET_GRP2_CON1].remote;
+
+    /* connections with the same configured remote share one entry */
+    CU_ASSERT_NOT_EQUAL_FATAL(id, SOAD_REMOTEID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].remote, id);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].remote, id);
+    CU_ASSERT_TRUE (SoAd_Remote_Wildcard(SoAd_Instance, id));
+    CU_ASSERT_EQUAL(SoAd_Remote_Lookup(SoAd_Instance, (const TcpIp_SockAddrType*)&socket_remote_any_v4), id);
+
+    /* configured remotes are referenced in place, not copied */
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance->remotes[id].addr, (const TcpIp_SockAddrType*)&socket_remote_any_v4);
+    CU_ASSERT_EQUAL(SoAd_Instance->remotes[id].store, SOAD_REMOTEID_INVALID);
+
+    CU_ASSERT_NOT_EQUAL(SoAd_Instance->connections[SOCKET_GRP4_CON1].remote, id);
+    CU_ASSERT_FALSE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP4_CON1].remote));
+}
+
+void main_test_remote_learned(void)
+{
+    SoAd_RemoteIdType      id_any = SoAd_Instance->connections[SOCKET_GRP2_CON1].remote;
+    uint16                 refs   = SoAd_Instance->remotes[id_any].refs;
+    SoAd_RemoteIdType      id;
+    SoAd_RemoteIdType      store;
+    TcpIp_SockAddrInetType inet;
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 1u;
+    inet.port    = SOCKET_GRP2_CON1;
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive_udp_1();
+
+    id = SoAd_Instance->connections[SOCKET_GRP2_CON1].remote;
+    CU_ASSERT_NOT_EQUAL(id, id_any);
+    CU_ASSERT_EQUAL(SoAd_Remote_Lookup(SoAd_Instance, (const TcpIp_SockAddrType*)&inet), id);
+    CU_ASSERT_EQUAL(SoAd_Instance->remotes[id].refs    , 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->remotes[id_any].refs, refs - 1u);
+    store = SoAd_Instance->remotes[id].store;
+    CU_ASSERT_FATAL(store < SOAD_REMOTE_STORE_COUNT);
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance->remotes[id].addr, &SoAd_Instance->remote_store[store].base);
+
+    /* alive supervision timeout returns to the configured wildcard */
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].remote, id_any);
+    CU_ASSERT_EQUAL(SoAd_Instance->remotes[id_any].refs, refs);
+    CU_ASSERT_EQUAL(SoAd_Remote_Lookup(SoAd_Instance, (const TcpIp_SockAddrType*)&inet), SOAD_REMOTEID_INVALID);
+
+    /* the store slot is freed with the last reference */
+    CU_ASSERT_EQUAL(SoAd_Instance->remote_store[store].base.domain, 0u);
+}
+
+static uint16 main_remote_used(void)
+{
+    uint16 used = 0u;
+    uint16 id;
+
+    for (id = 0u; id < SOAD_CFG_REMOTE_COUNT; ++id) {
+        if (SoAd_Instance->remotes[id].used == TRUE) {
+            used++;
+        }
+    }
+    return used;
+}
+
+void main_test_remote_churn(void)
+{
+    SoAd_RemoteIdType      ids[2];
+    TcpIp_SockAddrInetType inet;
+    uint16                 used;
+    uint16                 round;
+
+    SoAd_Init(&config);
+    used = main_remote_used();
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.port    = 1u;
+    for (round = 0u; round < 50u; ++round) {
+        inet.addr[0] = 0x0a000000u + (2u * round);
+        CU_ASSERT_EQUAL_FATAL(SoAd_Remote_Acquire(SoAd_Instance, (const TcpIp_SockAddrType*)&inet, &ids[0]), E_OK);
+        inet.addr[0] = 0x0a000001u + (2u * round);
+        CU_ASSERT_EQUAL_FATAL(SoAd_Remote_Acquire(SoAd_Instance, (const TcpIp_SockAddrType*)&inet, &ids[1]), E_OK);
+        SoAd_Remote_Release(SoAd_Instance, ids[0]);
+        SoAd_Remote_Release(SoAd_Instance, ids[1]);
+    }
+
+    /* released slots are reclaimed, so unknown remotes don't probe the whole table */
+    CU_ASSERT(main_remote_used() <= used + (SOAD_CFG_REMOTE_COUNT / 4u));
+    CU_ASSERT(main_remote_used() < SOAD_CFG_REMOTE_COUNT);
+    CU_ASSERT_EQUAL(SoAd_Remote_Lookup(SoAd_Instance, (const TcpIp_SockAddrType*)&inet), SOAD_REMOTEID_INVALID);
+
+    /* entries in use keep their ids and are still found */
+    CU_ASSERT_EQUAL(SoAd_Remote_Lookup(SoAd_Instance, (const TcpIp_SockAddrType*)&socket_remote_any_v4)
+                  , SoAd_Instance->connections[SOCKET_GRP2_CON1].remote);
+}
+
+void main_add_remote_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "shared"            , main_test_remote_shared);
+    CU_add_test(suite, "learned"           , main_test_remote_learned);
+    CU_add_test(suite, "churn"             , main_test_remote_churn);
+}
+
+void main_test_members_index(void)
+{
+    const SoAd_SoGrpMembersType* index = &SoAd_Instance->members;
+
+    CU_ASSERT_EQUAL(index->first[SOCKET_GRP1], 0u);
+    CU_ASSERT_EQUAL(index->first[SOCKET_GRP2], 2u);
+    CU_ASSERT_EQUAL(index->first[SOCKET_GRP3], 4u);
+    CU_ASSERT_EQUAL(index->first[SOCKET_GRP4], 5u);
+    CU_ASSERT_EQUAL(index->first[SOAD_CFG_CONNECTIONGROUP_COUNT], SOAD_CFG_CONNECTION_COUNT);
+
+    CU_ASSERT_EQUAL(index->members[index->first[SOCKET_GRP2]]     , SOCKET_GRP2_CON1);
+    CU_ASSERT_EQUAL(index->members[index->first[SOCKET_GRP2] + 1u], SOCKET_GRP2_CON2);
+    CU_ASSERT_EQUAL(index->members[index->first[SOCKET_GRP4]]     , SOCKET_GRP4_CON1);
+}
+
+void main_test_members_close(void)
+{
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].state, SOAD_SOCON_RECONNECT);
+
+    /* losing the listen socket takes down members without own socket only */
+    SoAd_TcpIpEvent(SoAd_Instance->groups[SOCKET_GRP1].socket_id, TCPIP_TCP_CLOSED);
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP1].socket_id , TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].state, SOAD_SOCON_OFFLINE);
+
+    /* other groups are untouched */
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+}
+
+void main_add_members_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "index"             , main_test_members_index);
+    CU_add_test(suite, "close"             , main_test_members_close);
+}
+
+void main_test_remoteaddr_get(void)
+{
+    TcpIp_SockAddrInetType  inet;
+    TcpIp_SockAddrInet6Type inet6;
+
+    inet.domain = TCPIP_AF_INET;
+    CU_ASSERT_EQUAL(SoAd_GetRemoteAddr(SOCKET_GRP4_CON1, (TcpIp_SockAddrType*)&inet), E_OK);
+    CU_ASSERT_EQUAL(inet.addr[0], 0x74000001);
+    CU_ASSERT_EQUAL(inet.port   , 8000);
+
+    /* buffer must fit the domain of the remote */
+    inet6.domain = TCPIP_AF_INET6;
+    CU_ASSERT_EQUAL(SoAd_GetRemoteAddr(SOCKET_GRP4_CON1, (TcpIp_SockAddrType*)&inet6), E_NOT_OK);
+}
+
+void main_test_remoteaddr_tcp(void)
+{
+    TcpIp_SockAddrInetType inet;
+    TcpIp_SockAddrInetType read;
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 0x0a000009;
+    inet.port    = 9;
+    read.domain  = TCPIP_AF_INET;
+
+    /* closed connection takes any remote */
+    CU_ASSERT_EQUAL(SoAd_SetRemoteAddr(SOCKET_GRP3_CON1, (const TcpIp_SockAddrType*)&inet), E_OK);
+    CU_ASSERT_EQUAL(SoAd_GetRemoteAddr(SOCKET_GRP3_CON1, (TcpIp_SockAddrType*)&read), E_OK);
+    CU_ASSERT_EQUAL(read.addr[0], 0x0a000009);
+
+    SoAd_ReleaseRemoteAddr(SOCKET_GRP3_CON1);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].remote, SoAd_Instance->connections[SOCKET_GRP3_CON1].remote_config);
+}
+
+void main_test_remoteaddr_unique(void)
+{
+    TcpIp_SockAddrInetType inet;
+    SoAd_SoConIdType       assigned = SOAD_SOCONID_INVALID;
+
+    main_test_mainfunction_open();
+    inet.domain  = TCPIP_AF_INET;
+    inet.port    = 5;
+
+    /* free wildcard connections are handed out in id order */
+    inet.addr[0] = 0x0a000001;
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON2, (const TcpIp_SockAddrType*)&inet, &assigned), E_OK);
+    CU_ASSERT_EQUAL(assigned, SOCKET_GRP2_CON1);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+
+    /* same remote maps to the same connection */
+    assigned = SOAD_SOCONID_INVALID;
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON2, (const TcpIp_SockAddrType*)&inet, &assigned), E_OK);
+    CU_ASSERT_EQUAL(assigned, SOCKET_GRP2_CON1);
+
+    inet.addr[0] = 0x0a000002;
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON1, (const TcpIp_SockAddrType*)&inet, &assigned), E_OK);
+    CU_ASSERT_EQUAL(assigned, SOCKET_GRP2_CON2);
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP2].free, SOAD_SOCONID_INVALID);
+
+    /* group is exhausted */
+    inet.addr[0] = 0x0a000003;
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON1, (const TcpIp_SockAddrType*)&inet, &assigned), E_NOT_OK);
+
+    /* open TCP connection keeps its remote */
+    CU_ASSERT_EQUAL(SoAd_SetRemoteAddr(SOCKET_GRP3_CON1, (const TcpIp_SockAddrType*)&inet), E_NOT_OK);
+}
+
+void main_test_remoteaddr_release(void)
+{
+    TcpIp_SockAddrInetType inet;
+    SoAd_SoConIdType       assigned = SOAD_SOCONID_INVALID;
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 0x0a000003;
+    inet.port    = 5;
+
+    /* online connection is released once closed */
+    SoAd_ReleaseRemoteAddr(SOCKET_GRP2_CON1);
+    CU_ASSERT_FALSE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON1].remote));
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON1, (const TcpIp_SockAddrType*)&inet, &assigned), E_NOT_OK);
+
+    SoAd_TcpIpEvent(SoAd_Instance->groups[SOCKET_GRP2].socket_id, TCPIP_UDP_CLOSED);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_TRUE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON1].remote));
+    CU_ASSERT_FALSE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON2].remote));
+
+    CU_ASSERT_EQUAL(SoAd_SetUniqueRemoteAddr(SOCKET_GRP2_CON1, (const TcpIp_SockAddrType*)&inet, &assigned), E_OK);
+    CU_ASSERT_EQUAL(assigned, SOCKET_GRP2_CON1);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
+
+    /* closed connection is released at once */
+    SoAd_ReleaseRemoteAddr(SOCKET_GRP2_CON1);
+    CU_ASSERT_TRUE(SoAd_Remote_Wildcard(SoAd_Instance, SoAd_Instance->connections[SOCKET_GRP2_CON1].remote));
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP2].free, SOCKET_GRP2_CON1);
+}
+
+void main_add_remoteaddr_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "get"               , main_test_remoteaddr_get);
+    CU_add_test(suite, "tcp"               , main_test_remoteaddr_tcp);
+    CU_add_test(suite, "unique"            , main_test_remoteaddr_unique);
+    CU_add_test(suite, "release"           , main_test_remoteaddr_release);
+}
+
+static SoAd_ConfigType      request_config;
+static SoAd_SoGrpConfigType request_group_2;
+static SoAd_SoGrpConfigType request_group_3;
+
+void main_test_request_manual(void)
+{
+    request_config            = config;
+    request_group_2           = socket_group_2;
+    request_group_2.automatic = FALSE;
+    request_group_3           = socket_group_3;
+    request_group_3.automatic = FALSE;
+    request_config.groups[SOCKET_GRP2] = &request_group_2;
+    request_config.groups[SOCKET_GRP3] = &request_group_3;
+    SoAd_Init(&request_config);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+
+    /* automatic connections are not under manual control */
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP1_CON1)       , E_NOT_OK);
+    CU_ASSERT_EQUAL(SoAd_CloseSoConGroup(SOCKET_GRP1, FALSE), E_NOT_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 0u);
+}
+
+void main_test_request_open_group(void)
+{
+    CU_ASSERT_EQUAL(SoAd_OpenSoConGroup(SOCKET_GRP2), E_OK);
+    CU_ASSERT_EQUAL(SoAd_OpenSoConGroup(SOCKET_GRP2), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 2u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 0u);
+    CU_ASSERT_NOT_EQUAL(SoAd_Instance->groups[SOCKET_GRP2].socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+}
+
+void main_test_request_open(void)
+{
+    struct suite_socket_state* socket_state;
+
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP3_CON1), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_FALSE(SoAd_Instance->connections[SOCKET_GRP3_CON1].request_open);
+
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id, TCPIP_SOCKETID_INVALID);
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id];
+    CU_ASSERT_EQUAL(socket_state->connect, TRUE);
+}
+
+void main_test_request_close(void)
+{
+    TcpIp_SocketIdType         socket_id = SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id;
+    struct suite_socket_state* socket_state = &suite_state.sockets[socket_id];
+
+    CU_ASSERT_EQUAL(SoAd_CloseSoCon(SOCKET_GRP3_CON1, TRUE), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(socket_state->connect, FALSE);
+    CU_ASSERT_FALSE(SoAd_Instance->connections[SOCKET_GRP3_CON1].request_abort);
+
+    SoAd_TcpIpEvent(socket_id, TCPIP_TCP_CLOSED);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+
+    /* not reopened without a new request */
+    SoAd_MainFunction();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_OFFLINE);
+}
+
+void main_test_request_close_group(void)
+{
+    TcpIp_SocketIdType socket_id = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+
+    CU_ASSERT_EQUAL(SoAd_CloseSoConGroup(SOCKET_GRP2, FALSE), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_OFFLINE);
+
+    /* the latest request wins */
+    CU_ASSERT_EQUAL(SoAd_CloseSoCon(SOCKET_GRP2_CON1, FALSE), E_OK);
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP2_CON1)        , E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->groups[SOCKET_GRP2].socket_id, socket_id);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_OFFLINE);
+
+    SoAd_Init(&config);
+}
+
+void main_test_request_budget(void)
+{
+    static SoAd_ConfigType budget_config;
+
+    budget_config             = request_config;
+    budget_config.main_budget = 2u;
+    SoAd_Init(&budget_config);
+
+    /* an open storm is spread over several main functions, oldest first */
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP3_CON1), E_OK);
+    CU_ASSERT_EQUAL(SoAd_OpenSoConGroup(SOCKET_GRP2), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 3u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 0u);
+
+    /* the remaining request and one connection */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP2_CON2].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_Instance->mainfunction_cursor, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_request_retry(void)
+{
+    const SoAd_SoConStatusType* status = &SoAd_Instance->connections[SOCKET_GRP3_CON1];
+    uint8                       cycles;
+
+    SoAd_Init(&request_config);
+
+    /* a failed open stays queued and is retried after the backoff */
+    suite_state.fail_socket = TRUE;
+    CU_ASSERT_EQUAL(SoAd_OpenSoCon(SOCKET_GRP3_CON1), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_OFFLINE);
+    CU_ASSERT_TRUE (status->request_open);
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 1u);
+    CU_ASSERT_TRUE (SoAd_Timer_Active(SoAd_Instance, SOAD_TIMER_ID(SOCKET_GRP3_CON1, SOAD_TIMER_RETRY)));
+
+    suite_state.fail_socket = FALSE;
+    for (cycles = 0u; (cycles < 10u) && (status->state == SOAD_SOCON_OFFLINE); ++cycles) {
+        SoAd_MainFunction();
+    }
+    CU_ASSERT_EQUAL(status->state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_FALSE(status->request_open);
+    CU_ASSERT_EQUAL(SoAd_Instance->requests.count, 0u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_request_ring(void)
+{
+    SoAd_SoConListType list;
+    SoAd_SoConIdType   id;
+    SoAd_SoConIdType   index;
+
+    SoAd_SoConList_Init(&list);
+    for (index = 0u; index < SOAD_CFG_CONNECTION_COUNT; ++index) {
+        SoAd_SoConList_Push(&list, index);
+    }
+
+    /* taken ones queue up again behind the rest, wrapping the ring */
+    CU_ASSERT_TRUE (SoAd_SoConList_PopOldest(&list, &id));
+    CU_ASSERT_EQUAL(id, 0u);
+    CU_ASSERT_TRUE (SoAd_SoConList_PopOldest(&list, &id));
+    CU_ASSERT_EQUAL(id, 1u);
+    SoAd_SoConList_Push(&list, 0u);
+    SoAd_SoConList_Push(&list, 1u);
+    SoAd_SoConList_Push(&list, 2u);
+    CU_ASSERT_EQUAL(list.count, SOAD_CFG_CONNECTION_COUNT);
+
+    for (index = 2u; index < SOAD_CFG_CONNECTION_COUNT + 2u; ++index) {
+        CU_ASSERT_TRUE (SoAd_SoConList_PopOldest(&list, &id));
+        CU_ASSERT_EQUAL(id, index % SOAD_CFG_CONNECTION_COUNT);
+    }
+    CU_ASSERT_FALSE(SoAd_SoConList_PopOldest(&list, &id));
+}
+
+void main_add_request_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "manual"            , main_test_request_manual);
+    CU_add_test(suite, "open_group"        , main_test_request_open_group);
+    CU_add_test(suite, "open"              , main_test_request_open);
+    CU_add_test(suite, "close"             , main_test_request_close);
+    CU_add_test(suite, "close_group"       , main_test_request_close_group);
+    CU_add_test(suite, "budget"            , main_test_request_budget);
+    CU_add_test(suite, "retry"             , main_test_request_retry);
+    CU_add_test(suite, "ring"              , main_test_request_ring);
+}
+
+void main_test_routing_tx(void)
+{
+    struct suite_socket_state* socket_state;
+    uint8                      data[8] = {0};
+    PduInfoType                info    = { data, sizeof(data) };
+    uint32                     prev;
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id];
+    prev         = socket_state->transmit_calls;
+
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(socket_state->transmit_calls, prev + 1u);
+
+    /* disabled route never reaches TcpIp */
+    CU_ASSERT_EQUAL(SoAd_DisableRouting(ROUTING_GRP1), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_NOT_OK);
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_NOT_OK);
+    CU_ASSERT_EQUAL(socket_state->transmit_calls, prev + 1u);
+
+    /* enabling for another connection leaves this one off */
+    CU_ASSERT_EQUAL(SoAd_EnableSpecificRouting(ROUTING_GRP1, SOCKET_GRP1_CON2), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_NOT_OK);
+
+    CU_ASSERT_EQUAL(SoAd_EnableSpecificRouting(ROUTING_GRP1, SOCKET_GRP1_CON1), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(socket_state->transmit_calls, prev + 2u);
+}
+
+void main_test_routing_trigger(void)
+{
+    struct suite_socket_state* socket_state;
+    uint32                     prev;
+
+    socket_state = &suite_state.sockets[SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id];
+    prev         = socket_state->transmit_calls;
+
+    CU_ASSERT_EQUAL(SoAd_IfRoutingGroupTransmit(ROUTING_GRP1), E_OK);
+    CU_ASSERT_EQUAL(suite_state.trigger_calls, 1u);
+    CU_ASSERT_EQUAL(socket_state->transmit_calls, prev + 1u);
+
+    /* group without PDU routes sends nothing */
+    CU_ASSERT_EQUAL(SoAd_IfRoutingGroupTransmit(ROUTING_GRP2), E_OK);
+    CU_ASSERT_EQUAL(suite_state.trigger_calls, 1u);
+
+    CU_ASSERT_EQUAL(SoAd_DisableRouting(ROUTING_GRP1), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfRoutingGroupTransmit(ROUTING_GRP1), E_OK);
+    CU_ASSERT_EQUAL(suite_state.trigger_calls, 1u);
+    CU_ASSERT_EQUAL(socket_state->transmit_calls, prev + 1u);
+}
+
+void main_test_routing_rx(void)
+{
+    TcpIp_SockAddrInetType      inet;
+    uint8                       data[10];
+    const SoAd_SocketRouteType* route = config.socket_routes[SOCKET_ROUTE2];
+    uint32                      prev  = suite_state.rxpdu[route->destination.pdu].rx_count;
+
+    inet.domain  = TCPIP_AF_INET;
+    inet.addr[0] = 1;
+    inet.port    = 1;
+
+    CU_ASSERT_EQUAL(SoAd_DisableRouting(ROUTING_GRP2), E_OK);
+    SoAd_RxIndication(SoAd_Instance->groups[SOCKET_GRP2].socket_id
+                    , (TcpIp_SockAddrType*)&inet
+                    , data
+                    , sizeof(data));
+    CU_ASSERT_EQUAL(suite_state.rxpdu[route->destination.pdu].rx_count, prev);
+
+    CU_ASSERT_EQUAL(SoAd_EnableRouting(ROUTING_GRP2), E_OK);
+    SoAd_RxIndication(SoAd_Instance->groups[SOCKET_GRP2].socket_id
+                    , (TcpIp_SockAddrType*)&inet
+                    , data
+                    , sizeof(data));
+    CU_ASSERT_EQUAL(suite_state.rxpdu[route->destination.pdu].rx_count, prev + sizeof(data));
+}
+
+void main_add_routing_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "tx"                , main_test_routing_tx);
+    CU_add_test(suite, "trigger"           , main_test_routing_trigger);
+    CU_add_test(suite, "rx"                , main_test_routing_rx);
+}
+
+void main_test_modechg_batch(void)
+{
+    /* nothing is reported before the main function runs */
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].calls, 0u);
+
+    main_test_mainfunction_open();
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].calls, 1u);
+    CU_ASSERT_EQUAL_FATAL(suite_state.mode_chg[0].count, 4u);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].events[0].connection, SOCKET_GRP1_CON1);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].events[0].mode      , SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].events[3].connection, SOCKET_GRP2_CON2);
+
+    /* second upper layer only sees its groups */
+    CU_ASSERT_EQUAL(suite_state.mode_chg[1].calls, 1u);
+    CU_ASSERT_EQUAL_FATAL(suite_state.mode_chg[1].count, 2u);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[1].events[0].connection, SOCKET_GRP2_CON1);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[1].events[1].connection, SOCKET_GRP2_CON2);
+}
+
+void main_test_modechg_coalesce(void)
+{
+    main_test_mainfunction_accept_1();
+    SoAd_TcpIpEvent(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id, TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_OFFLINE);
+
+    /* online and offline again within the cycle gives one event with the latest mode */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].calls, 2u);
+    CU_ASSERT_EQUAL_FATAL(suite_state.mode_chg[0].count, 1u);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].events[0].connection, SOCKET_GRP1_CON1);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].events[0].mode      , SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[1].calls, 1u);
+}
+
+void main_test_modechg_quiet(void)
+{
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.mode_chg[0].calls, 2u);
+    CU_ASSERT_EQUAL(suite_state.mode_chg[1].calls, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->modechg_list.count, 0u);
+}
+
+void main_add_modechg_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "batch"             , main_test_modechg_batch);
+    CU_add_test(suite, "coalesce"          , main_test_modechg_coalesce);
+    CU_add_test(suite, "quiet"             , main_test_modechg_quiet);
+}
+
+static SoAd_ConfigType priority_config;
+
+void main_test_priority_strict(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    priority_config           = config;
+    priority_config.tx_budget = 1u;
+    SoAd_Init(&priority_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    main_test_mainfunction_accept_2();
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[1].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_available = 8u;
+    suite_state.rxpdu[1].tx_available = 8u;
+
+    /* the bulk transfer is requested first, but the control PDU goes first */
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->tx_schedule.classes[0].count, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->tx_schedule.classes[1].count, 1u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[1].tx_confirmed, 1u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 0u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->tx_schedule.classes[1].count, 0u);
+}
+
+void main_test_priority_offline(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    /* waits unqueued until the connection is up */
+    SoAd_TcpIpEvent(SoAd_Instance->connections[SOCKET_GRP1_CON2].socket_id, TCPIP_TCP_RESET);
+    suite_state.rxpdu[1].tx_available = 8u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(1u, &info), E_OK);
+    CU_ASSERT_FALSE(SoAd_Instance->tx_schedule.queued[SOCKET_GRP1_CON2]);
+
+    SoAd_MainFunction();
+    main_test_mainfunction_accept_2();
+    CU_ASSERT_TRUE(SoAd_Instance->tx_schedule.queued[SOCKET_GRP1_CON2]);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[1].tx_confirmed, 2u);
+
+    SoAd_Init(&config);
+}
+
+static SoAd_ConfigType      shaping_config;
+static SoAd_SoConConfigType shaping_con;
+static SoAd_SoGrpConfigType shaping_grp;
+
+static void main_test_shaping_online(void)
+{
+    SoAd_Init(&shaping_config);
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    main_test_mainfunction_accept_2();
+}
+
+void main_test_shaping_connection(void)
+{
+    uint8              data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+    uint32             calls;
+
+    shaping_con                 = socket_group_1_conn_1;
+    shaping_con.tx_shape.rate   = 8u;
+    shaping_con.tx_shape.period = 2u;
+    shaping_con.tx_shape.burst  = 8u;
+    shaping_config              = config;
+    shaping_config.connections[SOCKET_GRP1_CON1] = &shaping_con;
+    main_test_shaping_online();
+
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    calls     = suite_state.sockets[socket_id].transmit_calls;
+    SoAd_Instance->connections[SOCKET_GRP1_CON1].tx_shape.refill = SoAd_Instance->timer_wheel.now;
+
+    /* burst goes out at once, the rest is held instead of rejected */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, calls + 1u);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, calls + 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_head, 0u);
+
+    /* a newer value replaces the held one */
+    data[0] = 9u;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->if_held[0].next, SOAD_PDUID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Data(SoAd_Instance, SoAd_Instance->if_held[0].buffer)[0], 9u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, calls + 1u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, calls + 2u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_head, SOAD_PDUID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->if_held[0].buffer, SOAD_BUFFERID_INVALID);
+
+    /* TP waits in the scheduler until refilled */
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_available = 8u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 0u);
+    CU_ASSERT_TRUE(SoAd_Instance->tx_schedule.queued[SOCKET_GRP1_CON1]);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+}
+
+void main_test_shaping_group(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_1;
+    TcpIp_SocketIdType socket_2;
+    uint32             calls_1;
+    uint32             calls_2;
+
+    shaping_grp                 = socket_group_1;
+    shaping_grp.tx_shape.rate   = 8u;
+    shaping_grp.tx_shape.period = 1u;
+    shaping_grp.tx_shape.burst  = 8u;
+    shaping_config              = config;
+    shaping_config.groups[SOCKET_GRP1] = &shaping_grp;
+    main_test_shaping_online();
+
+    socket_1 = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    socket_2 = SoAd_Instance->connections[SOCKET_GRP1_CON2].socket_id;
+    calls_1  = suite_state.sockets[socket_1].transmit_calls;
+    calls_2  = suite_state.sockets[socket_2].transmit_calls;
+
+    /* members share the budget of their group */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_1].transmit_calls, calls_1 + 1u);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_2].transmit_calls, calls_2);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_2].transmit_calls, calls_2 + 1u);
+}
+
+void main_test_shaping_offline(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    /* budget of the previous test is spent */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].if_head, 1u);
+
+    SoAd_TcpIpEvent(SoAd_Instance->connections[SOCKET_GRP1_CON2].socket_id, TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON2].if_head, SOAD_PDUID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_Instance->if_held[1].buffer, SOAD_BUFFERID_INVALID);
+
+    SoAd_Init(&config);
+}
+
+static SoAd_ConfigType      ifretry_config;
+static SoAd_SoConConfigType ifretry_con;
+static SoAd_PduRouteType    ifretry_route;
+
+static void main_ifretry_init(void)
+{
+    ifretry_con          = socket_group_1_conn_1;
+    ifretry_con.if_retry = 1u;
+    ifretry_config       = config;
+    ifretry_config.connections[SOCKET_GRP1_CON1] = &ifretry_con;
+    SoAd_Init(&ifretry_config);
+    suite_state.rxpdu[0].if_confirmed = 0u;
+    suite_state.fail_transmit         = FALSE;
+}
+
+static TcpIp_SocketIdType main_ifretry_online(void)
+{
+    TcpIp_SocketIdType socket_id;
+
+    main_ifretry_init();
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    suite_state.sockets[socket_id].transmit_calls = 0u;
+    return socket_id;
+}
+
+void main_test_ifretry_offline(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    main_ifretry_init();
+
+    /* accepted before the connection is up, sent once it is */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 1u);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 0u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 0u);
+    SoAd_TxConfirmation(socket_id, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_ifretry_refused(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id = main_ifretry_online();
+
+    suite_state.fail_transmit = TRUE;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    data[0] = 7u;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 1u);
+    CU_ASSERT_EQUAL(SoAd_Buffer_Data(SoAd_Instance, SoAd_Instance->if_held[0].buffer)[0], 7u);
+
+    /* stays first in line while refused */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 1u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 0u);
+
+    suite_state.fail_transmit = FALSE;
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    SoAd_TxConfirmation(socket_id, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->if_held[0].buffer, SOAD_BUFFERID_INVALID);
+
+    /* counted once when sent, refusals of a held PDU are no drops */
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].connections[SOCKET_GRP1_CON1].tx_pdus      , 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].connections[SOCKET_GRP1_CON1].tx_drop_tcpip, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->measurement[0].pdu_routes[0].tx_dropped                   , 0u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_ifretry_reset(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    /* survives a reset of the connection */
+    SoAd_TcpIpEvent(main_ifretry_online(), TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 1u);
+    main_test_mainfunction_accept_1();
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].if_count, 0u);
+    SoAd_TxConfirmation(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_ifretry_udp(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    /* group connections send on the socket of their group */
+    ifretry_route = pdu_route_2;
+    ifretry_route.destination.connection = SOCKET_GRP2_CON1;
+    ifretry_config = config;
+    ifretry_config.pdu_routes[1] = &ifretry_route;
+    SoAd_Init(&ifretry_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP2_CON1].state, SOAD_SOCON_ONLINE);
+
+    socket_id = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_add_ifretry_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "offline"           , main_test_ifretry_offline);
+    CU_add_test(suite, "refused"           , main_test_ifretry_refused);
+    CU_add_test(suite, "reset"             , main_test_ifretry_reset);
+    CU_add_test(suite, "udp"               , main_test_ifretry_udp);
+}
+
+static SoAd_ConfigType      inflight_config;
+static SoAd_PduRouteType    inflight_route;
+static SoAd_IfTxType        inflight_iftx;
+
+void main_test_inflight_ack(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    suite_state.rxpdu[0].if_confirmed = 0u;
+
+    /* confirmed once all bytes are acknowledged */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    SoAd_TxConfirmation(socket_id, 4u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 0u);
+    SoAd_TxConfirmation(socket_id, 10u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+    SoAd_TxConfirmation(socket_id, 2u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 2u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP1_CON1].count, 0u);
+}
+
+void main_test_inflight_tp(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+
+    /* TP bytes sent first are acknowledged first */
+    suite_state.rxpdu[0].tx_available = 8u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    SoAd_TxConfirmation(socket_id, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 2u);
+    SoAd_TxConfirmation(socket_id, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 3u);
+}
+
+void main_test_inflight_partial(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    SoAd_Init(&config);
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    suite_state.rxpdu[0].if_confirmed = 0u;
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* only the bytes TcpIp pulled are in flight */
+    suite_state.tx_copy_limit         = 5u;
+    suite_state.rxpdu[0].tx_available = 8u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 5u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP1_CON1].count, 1u);
+    SoAd_TxConfirmation(socket_id, 5u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP1_CON1].count, 0u);
+
+    /* the rest goes with the next main function */
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    SoAd_TxConfirmation(socket_id, 11u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP1_CON1].count, 0u);
+
+    suite_state.tx_copy_limit = 0u;
+    SoAd_Init(&config);
+}
+
+void main_test_inflight_full(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    uint8              index;
+
+    for (index = 0u; index < SOAD_CFG_TX_INFLIGHT_SIZE; ++index) {
+        CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    }
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_NOT_OK);
+
+    SoAd_TxConfirmation(socket_id, 8u);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+
+    /* lost with the connection */
+    SoAd_TcpIpEvent(socket_id, TCPIP_TCP_RESET);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP1_CON1].count, 0u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 4u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_inflight_batch(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    inflight_iftx                  = suite_iftx;
+    inflight_iftx.tx_confirmations = suite_if_confirmations;
+    inflight_route                 = pdu_route_1;
+    inflight_route.upper_if        = &inflight_iftx;
+    inflight_config                = config;
+    inflight_config.pdu_routes[0]  = &inflight_route;
+    SoAd_Init(&inflight_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    suite_state.rxpdu[0].if_confirmed = 0u;
+    suite_state.if_batches            = 0u;
+
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    SoAd_TxConfirmation(socket_id, 20u);
+    CU_ASSERT_EQUAL(suite_state.if_batches, 1u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 2u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_inflight_udp(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    inflight_route = pdu_route_1;
+    inflight_route.destination.connection = SOCKET_GRP2_CON1;
+    inflight_route.destination.routing_groups = 0u;
+    inflight_config = config;
+    inflight_config.pdu_routes[0] = &inflight_route;
+    SoAd_Init(&inflight_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    suite_state.rxpdu[0].if_confirmed = 0u;
+
+    /* no acknowledgement over UDP, confirmed by the next main function */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 0u);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_inflight_resend(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    inflight_route = pdu_route_1;
+    inflight_route.destination.connection = SOCKET_GRP2_CON1;
+    inflight_route.destination.routing_groups = 0u;
+    inflight_config = config;
+    inflight_config.pdu_routes[0] = &inflight_route;
+    SoAd_Init(&inflight_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    suite_state.rxpdu[0].if_confirmed = 0u;
+
+    /* a transmit from the confirmation waits for the next main function */
+    suite_state.if_resend = 1u;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 1u);
+    CU_ASSERT_EQUAL(suite_state.if_resend, 0u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP2_CON1].count, 1u);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].if_confirmed, 2u);
+    CU_ASSERT_EQUAL(SoAd_Instance->inflight[SOCKET_GRP2_CON1].count, 0u);
+
+    SoAd_Init(&config);
+}
+
+static SoAd_ConfigType      tpstream_config;
+static SoAd_PduRouteType    tpstream_route;
+
+void main_test_tpstream_length(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* no more than the PDU is taken from the upper layer */
+    suite_state.rxpdu[0].tx_available = 20u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+    suite_state.rxpdu[0].tx_available = 0u;
+
+    /* waits for data of a known length */
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+    suite_state.rxpdu[0].tx_available = 8u;
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 16u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 2u);
+    SoAd_TxConfirmation(SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id, 16u);
+}
+
+void main_test_tpstream_unknown(void)
+{
+    const uint32 total   = 3u * 1024u * 1024u;
+    PduInfoType  info    = { NULL_PTR, 0u };
+    uint32       cycles;
+
+    /* far beyond PduLengthType, until the upper layer runs dry */
+    suite_state.rxpdu[0].tx_available = total;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_NOT_OK);
+
+    for (cycles = 0u; (cycles < 100u) && (suite_state.rxpdu[0].tx_confirmed == 2u); ++cycles) {
+        SoAd_MainFunction();
+    }
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 3u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, total);
+    CU_ASSERT_PTR_NULL(SoAd_Instance->connections[SOCKET_GRP1_CON1].tx_route);
+
+    SoAd_Init(&config);
+}
+
+void main_test_tpstream_udp(void)
+{
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    PduInfoType        stream  = { NULL_PTR, 0u };
+    TcpIp_SocketIdType socket_id;
+
+    tpstream_route = pdu_route_1;
+    tpstream_route.destination.connection = SOCKET_GRP2_CON1;
+    tpstream_route.destination.routing_groups = 0u;
+    tpstream_config = config;
+    tpstream_config.pdu_routes[0] = &tpstream_route;
+    SoAd_Init(&tpstream_config);
+
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    socket_id = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* a datagram needs its length up front */
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &stream), E_NOT_OK);
+
+    /* and goes out whole, copied through the group socket */
+    suite_state.rxpdu[0].tx_available = 4u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 0u);
+
+    suite_state.rxpdu[0].tx_available = 8u;
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+static SoAd_ConfigType      header_config;
+static SoAd_PduRouteType    header_route;
+static SoAd_SoGrpConfigType header_grp;
+
+static void main_test_header_setup(SoAd_SoGrpIdType group, SoAd_SoConIdType con, PduIdType pdu)
+{
+    header_grp   = *config.groups[group];
+    header_grp.header = TRUE;
+    header_route = *config.pdu_routes[pdu];
+    header_route.destination.connection     = con;
+    header_route.destination.routing_groups = 0u;
+    header_route.destination.header_id      = 0x01020304u;
+    header_config = config;
+    header_config.groups[group]   = &header_grp;
+    header_config.pdu_routes[pdu] = &header_route;
+    SoAd_Init(&header_config);
+}
+
+void main_test_header_if_tcp(void)
+{
+    uint8              data[3]   = { 0x11, 0x22, 0x33 };
+    const uint8        wire[11]  = { 1, 2, 3, 4, 0, 0, 0, 3, 0x11, 0x22, 0x33 };
+    PduInfoType        info      = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    main_test_header_setup(SOCKET_GRP1, SOCKET_GRP1_CON2, 1u);
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    main_test_mainfunction_accept_2();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON2].socket_id;
+
+    /* header and payload are gathered by one transmit */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(suite_state.tx_wire_length, sizeof(wire));
+    CU_ASSERT_EQUAL(memcmp(suite_state.tx_wire, wire, sizeof(wire)), 0);
+    CU_ASSERT_EQUAL(SoAd_Instance->if_gather.connection, SOAD_SOCONID_INVALID);
+
+    SoAd_Init(&config);
+}
+
+void main_test_header_if_udp(void)
+{
+    uint8              data[2]   = { 0x44, 0x55 };
+    const uint8        wire[10]  = { 1, 2, 3, 4, 0, 0, 0, 2, 0x44, 0x55 };
+    PduInfoType        info      = { data, sizeof(data) };
+    TcpIp_SocketIdType socket_id;
+
+    main_test_header_setup(SOCKET_GRP2, SOCKET_GRP2_CON1, 1u);
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    socket_id = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+
+    /* a single datagram, copied through the group socket */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(1u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(suite_state.tx_wire_length, sizeof(wire));
+    CU_ASSERT_EQUAL(memcmp(suite_state.tx_wire, wire, sizeof(wire)), 0);
+
+    SoAd_Init(&config);
+}
+
+void main_test_header_tp_tcp(void)
+{
+    uint8              data[4] = {0};
+    const uint8        wire[12] = { 1, 2, 3, 4, 0, 0, 0, 4, 0xa0, 0xa0, 0xa0, 0xa0 };
+    PduInfoType        info    = { data, sizeof(data) };
+    PduInfoType        stream  = { NULL_PTR, 0u };
+    TcpIp_SocketIdType socket_id;
+
+    main_test_header_setup(SOCKET_GRP1, SOCKET_GRP1_CON1, 0u);
+    main_test_mainfunction_open();
+    main_test_mainfunction_accept_1();
+    socket_id = SoAd_Instance->connections[SOCKET_GRP1_CON1].socket_id;
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* the header needs the length up front */
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &stream), E_NOT_OK);
+
+    suite_state.rxpdu[0].tx_available = 4u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(suite_state.tx_wire_length, sizeof(wire));
+    CU_ASSERT_EQUAL(memcmp(suite_state.tx_wire, wire, sizeof(wire)), 0);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 4u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_header_tp_udp(void)
+{
+    uint8              data[4] = {0};
+    const uint8        wire[12] = { 1, 2, 3, 4, 0, 0, 0, 4, 0xa0, 0xa0, 0xa0, 0xa0 };
+    PduInfoType        info    = { data, sizeof(data) };
+    PduInfoType        large   = { NULL_PTR, 0xfff8u };
+    TcpIp_SocketIdType socket_id;
+
+    main_test_header_setup(SOCKET_GRP2, SOCKET_GRP2_CON1, 0u);
+    main_test_mainfunction_open();
+    main_test_mainfunction_receive(SOCKET_GRP2, SOCKET_GRP2_CON1);
+    socket_id = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* header and payload must fit one datagram */
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &large), E_NOT_OK);
+
+    suite_state.rxpdu[0].tx_available = 4u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_EQUAL(suite_state.tx_wire_length, sizeof(wire));
+    CU_ASSERT_EQUAL(memcmp(suite_state.tx_wire, wire, sizeof(wire)), 0);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_test_instance_separate(void)
+{
+    void*              memory_a = malloc(SoAd_GetInstanceSize(&config));
+    void*              memory_b = malloc(SoAd_GetInstanceSize(&config));
+    SoAd_InstanceType* a;
+    SoAd_InstanceType* b;
+
+    a = SoAd_InitInstance(memory_a, 1u, &config);
+    b = SoAd_InitInstance(memory_b, 2u, &config);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(b);
+    CU_ASSERT_PTR_EQUAL(a, memory_a);
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+    CU_ASSERT_EQUAL(a->instance_id, 1u);
+    CU_ASSERT_PTR_EQUAL(a->config, &config);
+
+    /* each instance opens its own sockets */
+    CU_ASSERT_PTR_EQUAL(SoAd_SetInstance(a), &SoAd_DefaultInstance);
+    main_test_mainfunction_open();
+    CU_ASSERT_EQUAL(b->groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    CU_ASSERT_PTR_EQUAL(SoAd_SetInstance(b), a);
+    main_test_mainfunction_open();
+    CU_ASSERT_NOT_EQUAL(a->groups[SOCKET_GRP1].socket_id, b->groups[SOCKET_GRP1].socket_id);
+
+    /* callbacks from TcpIp reach the selected instance only */
+    (void)SoAd_SetInstance(a);
+    main_test_mainfunction_accept_1();
+    CU_ASSERT_EQUAL(a->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_ONLINE);
+    CU_ASSERT_EQUAL(b->connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_RECONNECT);
+    CU_ASSERT_EQUAL(SoAd_DefaultInstance.connections[SOCKET_GRP1_CON1].state, SOAD_SOCON_OFFLINE);
+
+    CU_ASSERT_PTR_EQUAL(SoAd_SetInstance(NULL_PTR), a);
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+
+    free(memory_a);
+    free(memory_b);
+}
+
+void main_test_instance_explicit(void)
+{
+    void*              memory = malloc(SoAd_GetInstanceSize(&config));
+    uint8              data[8] = {0};
+    PduInfoType        info    = { data, sizeof(data) };
+    SoAd_InstanceType* a;
+    TcpIp_SocketIdType socket_id;
+
+    a = SoAd_InitInstance(memory, 1u, &config);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+
+    /* the instance is only used for the call */
+    SoAd_MainFunctionInstance(a);
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+    CU_ASSERT_NOT_EQUAL(a->groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_EQUAL(SoAd_DefaultInstance.groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    (void)SoAd_SetInstance(a);
+    main_test_mainfunction_accept_1();
+    (void)SoAd_SetInstance(NULL_PTR);
+    socket_id = a->connections[SOCKET_GRP1_CON1].socket_id;
+
+    /* transmits reach the instance given, with the default one selected */
+    CU_ASSERT_EQUAL(SoAd_IfTransmitInstance(a, 0u, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.sockets[socket_id].transmit_calls, 1u);
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+
+    SoAd_Init(&config);
+    free(memory);
+}
+
+void main_test_instance_core(void)
+{
+    void*              memory = malloc(SoAd_GetInstanceSize(&config));
+    SoAd_InstanceType* a;
+
+    a = SoAd_InitInstance(memory, 1u, &config);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(a);
+
+    /* each core keeps its own selection */
+    suite_core_id = 1u;
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+    CU_ASSERT_PTR_EQUAL(SoAd_SetInstance(a), &SoAd_DefaultInstance);
+    main_test_mainfunction_open();
+    CU_ASSERT_NOT_EQUAL(a->groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    suite_core_id = 0u;
+    CU_ASSERT_PTR_EQUAL(SoAd_Instance, &SoAd_DefaultInstance);
+    CU_ASSERT_EQUAL(SoAd_DefaultInstance.groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    suite_core_id = 1u;
+    CU_ASSERT_PTR_EQUAL(SoAd_SetInstance(NULL_PTR), a);
+    suite_core_id = 0u;
+
+    SoAd_Init(&config);
+    free(memory);
+}
+
+void main_add_instance_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "separate"          , main_test_instance_separate);
+    CU_add_test(suite, "explicit"          , main_test_instance_explicit);
+    CU_add_test(suite, "core"              , main_test_instance_core);
+}
+
+void main_add_header_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "if_tcp"            , main_test_header_if_tcp);
+    CU_add_test(suite, "if_udp"            , main_test_header_if_udp);
+    CU_add_test(suite, "tp_tcp"            , main_test_header_tp_tcp);
+    CU_add_test(suite, "tp_udp"            , main_test_header_tp_udp);
+}
+
+void main_add_tpstream_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "length"            , main_test_tpstream_length);
+    CU_add_test(suite, "unknown"           , main_test_tpstream_unknown);
+    CU_add_test(suite, "udp"               , main_test_tpstream_udp);
+}
+
+void main_add_inflight_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "ack"               , main_test_inflight_ack);
+    CU_add_test(suite, "tp"                , main_test_inflight_tp);
+    CU_add_test(suite, "full"              , main_test_inflight_full);
+    CU_add_test(suite, "batch"             , main_test_inflight_batch);
+    CU_add_test(suite, "udp"               , main_test_inflight_udp);
+    CU_add_test(suite, "resend"            , main_test_inflight_resend);
+    CU_add_test(suite, "partial"           , main_test_inflight_partial);
+}
+
+void main_test_shaping_period(void)
+{
+    /* a rate without a period can't be refilled */
+    shaping_con                 = socket_group_1_conn_1;
+    shaping_con.tx_shape.rate   = 8u;
+    shaping_con.tx_shape.period = 0u;
+    shaping_config              = config;
+    shaping_config.connections[SOCKET_GRP1_CON1] = &shaping_con;
+
+    suite_state.det_expected = 1u;
+    SoAd_Init(&shaping_config);
+    CU_ASSERT_EQUAL(suite_state.det_expected, 0u);
+    CU_ASSERT_PTR_NULL(SoAd_Instance->config);
+
+    shaping_grp                 = socket_group_1;
+    shaping_grp.tx_shape.rate   = 8u;
+    shaping_grp.tx_shape.period = 0u;
+    shaping_config              = config;
+    shaping_config.groups[SOCKET_GRP1] = &shaping_grp;
+
+    suite_state.det_expected = 1u;
+    SoAd_Init(&shaping_config);
+    CU_ASSERT_EQUAL(suite_state.det_expected, 0u);
+    CU_ASSERT_PTR_NULL(SoAd_Instance->config);
+}
+
+void main_test_shaping_partial(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    shaping_con                 = socket_group_1_conn_1;
+    shaping_con.tx_shape.rate   = 8u;
+    shaping_con.tx_shape.period = 2u;
+    shaping_con.tx_shape.burst  = 8u;
+    shaping_config              = config;
+    shaping_config.connections[SOCKET_GRP1_CON1] = &shaping_con;
+    main_test_shaping_online();
+    SoAd_Instance->connections[SOCKET_GRP1_CON1].tx_shape.refill = SoAd_Instance->timer_wheel.now;
+
+    /* only the bytes TcpIp pulled use up budget */
+    suite_state.tx_copy_limit         = 3u;
+    suite_state.rxpdu[0].tx_available = 8u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP1_CON1].tx_shape.tokens, 5);
+
+    suite_state.tx_copy_limit = 0u;
+    SoAd_Init(&config);
+}
+
+void main_test_shaping_chunk(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, 20u };
+    uint32      round;
+
+    shaping_con                 = socket_group_1_conn_1;
+    shaping_con.tx_shape.rate   = 8u;
+    shaping_con.tx_shape.period = 2u;
+    shaping_con.tx_shape.burst  = 8u;
+    shaping_config              = config;
+    shaping_config.connections[SOCKET_GRP1_CON1] = &shaping_con;
+    main_test_shaping_online();
+    SoAd_Instance->connections[SOCKET_GRP1_CON1].tx_shape.refill = SoAd_Instance->timer_wheel.now;
+    suite_state.rxpdu[0].tx_confirmed = 0u;
+    suite_state.rxpdu[0].tx_copied    = 0u;
+
+    /* a large TP PDU goes out a burst at a time */
+    suite_state.rxpdu[0].tx_available = 20u;
+    CU_ASSERT_EQUAL(SoAd_TpTransmit(0u, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.tx_wire_length, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 8u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 0u);
+
+    for (round = 0u; (round < 8u) && (suite_state.rxpdu[0].tx_confirmed == 0u); ++round) {
+        SoAd_MainFunction();
+        CU_ASSERT(suite_state.tx_wire_length <= 8u);
+    }
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_copied, 20u);
+    CU_ASSERT_EQUAL(suite_state.rxpdu[0].tx_confirmed, 1u);
+
+    SoAd_Init(&config);
+}
+
+void main_add_shaping_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "connection"        , main_test_shaping_connection);
+    CU_add_test(suite, "group"             , main_test_shaping_group);
+    CU_add_test(suite, "offline"           , main_test_shaping_offline);
+    CU_add_test(suite, "period"            , main_test_shaping_period);
+    CU_add_test(suite, "partial"           , main_test_shaping_partial);
+    CU_add_test(suite, "chunk"             , main_test_shaping_chunk);
+}
+
+void main_add_priority_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "strict"            , main_test_priority_strict);
+    CU_add_test(suite, "offline"           , main_test_priority_offline);
+}
+
+void main_add_measurement_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "counters"          , main_test_measurement_counters);
+    CU_add_test(suite, "reset"             , main_test_measurement_reset);
+}
+
+void main_add_reuse_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "prepare"           , main_test_reuse_prepare);
+    CU_add_test(suite, "reconnect"         , main_test_reuse_reconnect);
+    CU_add_test(suite, "udp"               , main_test_reuse_udp);
+}
+
+void main_add_localaddr_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "wait"              , main_test_localaddr_wait);
+    CU_add_test(suite, "assign"            , main_test_localaddr_assign);
+    CU_add_test(suite, "lost"              , main_test_localaddr_lost);
+}
+
+int main(void)
+{
+    CU_pSuite suite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+      return CU_get_error();
+
+    /* add a suite to the registry */
+    suite = CU_add_suite("Suite_Generic", suite_init, suite_clean);
+    main_add_generic_suite(suite);
+
+    suite = CU_add_suite("Suite_MainFunction", suite_init, suite_clean);
+    main_add_mainfunction_suite(suite);
+
+    suite = CU_add_suite("Suite_Buffer", suite_init, suite_clean);
+    main_add_buffer_suite(suite);
+
+    suite = CU_add_suite("Suite_Timer", suite_init, suite_clean);
+    main_add_timer_suite(suite);
+
+    suite = CU_add_suite("Suite_IfRetry", suite_init, suite_clean);
+    main_add_ifretry_suite(suite);
+
+    suite = CU_add_suite("Suite_InFlight", suite_init, suite_clean);
+    main_add_inflight_suite(suite);
+
+    suite = CU_add_suite("Suite_TpStream", suite_init, suite_clean);
+    main_add_tpstream_suite(suite);
+
+    suite = CU_add_suite("Suite_Header", suite_init, suite_clean);
+    main_add_header_suite(suite);
+
+    suite = CU_add_suite("Suite_Instance", suite_init, suite_clean);
+    main_add_instance_suite(suite);
+
+    suite = CU_add_suite("Suite_LocalAddr", suite_init, suite_clean);
+    main_add_localaddr_suite(suite);
+
+    suite = CU_add_suite("Suite_Reuse", suite_init, suite_clean);
+    main_add_reuse_suite(suite);
+
+    suite = CU_add_suite("Suite_Measurement", suite_init, suite_clean);
+    main_add_measurement_suite(suite);
+
+    suite = CU_add_suite("Suite_Trace", suite_init, suite_clean);
+    main_add_trace_suite(suite);
+
+    suite = CU_add_suite("Suite_Budget", suite_init, suite_clean);
+    main_add_budget_suite(suite);
+
+    suite = CU_add_suite("Suite_Window", suite_init, suite_clean);
+    main_add_window_suite(suite);
+
+    suite = CU_add_suite("Suite_RateLimit", suite_init, suite_clean);
+    main_add_ratelimit_suite(suite);
+
+    suite = CU_add_suite("Suite_Filter", suite_init, suite_clean);
+    main_add_filter_suite(suite);
+
+    suite = CU_add_suite("Suite_Remote", suite_init, suite_clean);
+    main_add_remote_suite(suite);
+
+    suite = CU_add_suite("Suite_Members", suite_init, suite_clean);
+    main_add_members_suite(suite);
+
+    suite = CU_add_suite("Suite_RemoteAddr", suite_init, suite_clean);
+    main_add_remoteaddr_suite(suite);
+
+    suite = CU_add_suite("Suite_Request", suite_init, suite_clean);
+    main_add_request_suite(suite);
+
+    suite = CU_add_suite("Suite_Routing", suite_init, suite_clean);
+    main_add_routing_suite(suite);
+
+    suite = CU_add_suite("Suite_ModeChg", suite_init, suite_clean);
+    main_add_modechg_suite(suite);
+
+    suite = CU_add_suite("Suite_Priority", suite_init, suite_clean);
+    main_add_priority_suite(suite);
+
+    suite = CU_add_suite("Suite_Shaping", suite_init, suite_clean);
+    main_add_shaping_suite(suite);
 
 
     /* Run all tests using the CUnit Basic interface */
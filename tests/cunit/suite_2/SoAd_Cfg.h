@@ -0,0 +1,32 @@
+/* Copyright (C) 2015 Joakim Plate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef SOAD_CFG_H_
+#define SOAD_CFG_H_
+
+#include "Std_Types.h"
+
+#define SOAD_CFG_ENABLE_DEVELOPMENT_ERROR STD_ON
+#define SOAD_CFG_CONCURRENT_TX            STD_ON
+
+ #define SOAD_CFG_SOCKETROUTE_COUNT     1u
+ #define SOAD_CFG_PDUROUTE_COUNT        8u
+ #define SOAD_CFG_CONNECTIONGROUP_COUNT 3u
+ #define SOAD_CFG_CONNECTION_COUNT      7u
+ #define SOAD_CFG_ROUTINGGROUP_COUNT    1u
+
+#endif /* SOAD_CFG_H_ */
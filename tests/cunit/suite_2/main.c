@@ -0,0 +1,596 @@
+/* Copyright (C) 2015 Joakim Plate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * SoAd_IfTransmit from several threads, while the control thread moves
+ * the connections between remotes, accepts and reopens sockets. Build with -fsanitize=thread to
+ * check for data races, see the tsan target of the Makefile.
+ */
+
+#include "SoAd.c"
+
+/* tests look at the instance selected for the calling context */
+#define SoAd_Instance SoAd_Instance_Get()
+
+#include "CUnit/Basic.h"
+#include "CUnit/Automated.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define SUITE_TRANSMITTERS  3
+#define SUITE_ROUNDS        2000u
+#define SUITE_ROUTES        4u      /**< UDP routes transmitted in parallel, the next one is confirmed */
+#define SUITE_ROUTES_TCP    5u      /**< first of the TCP routes, one per TCP connection */
+
+#define SOCKET_GRP1         0
+#define SOCKET_GRP2         1       /**< TCP server, sockets come from accept */
+#define SOCKET_GRP3         2       /**< TCP client, reopened after each close */
+#define SOCKET_GRP2_CON1    4
+#define SOCKET_GRP2_CON2    5
+#define SOCKET_GRP3_CON1    6
+#define SOCKET_ROUTE1       0
+#define ROUTING_GRP1        0
+
+struct suite_state {
+    uint32             socket_id;
+    uint32             det_errors;
+    uint32             sent;
+    uint32             torn;
+    uint32             stop;
+    uint32             confirmed;
+    boolean            resend;
+    PduIdType          route_first;        /**< routes the transmitters cycle through */
+    PduIdType          route_count;
+};
+
+struct suite_state suite_state;
+
+Std_ReturnType Det_ReportError(
+        uint16 ModuleId,
+        uint8 InstanceId,
+        uint8 ApiId,
+        uint8 ErrorId
+    )
+{
+    __atomic_fetch_add(&suite_state.det_errors, 1u, __ATOMIC_RELAXED);
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_SoAdGetSocket(
+        TcpIp_DomainType            domain,
+        TcpIp_ProtocolType          protocol,
+        TcpIp_SocketIdType*         id
+    )
+{
+    *id = (TcpIp_SocketIdType)__atomic_add_fetch(&suite_state.socket_id, 1u, __ATOMIC_RELAXED);
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_Bind(
+        TcpIp_SocketIdType          id,
+        TcpIp_LocalAddrIdType       local,
+        uint16* port
+    )
+{
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_TcpListen(
+        TcpIp_SocketIdType id,
+        uint16 channels
+    )
+{
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_TcpConnect(
+        TcpIp_SocketIdType          id,
+        const TcpIp_SockAddrType*   remote
+    )
+{
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_Close(
+        TcpIp_SocketIdType          id,
+        boolean                     abort
+    )
+{
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_TcpReceived(
+        TcpIp_SocketIdType id,
+        uint32             len
+    )
+{
+    return E_OK;
+}
+
+Std_ReturnType TcpIp_TcpTransmit(
+        TcpIp_SocketIdType  id,
+        const uint8*        data,
+        uint32              aailable,
+        boolean             force
+    )
+{
+    /* a closing connection may lose its socket before its state */
+    if (id == TCPIP_SOCKETID_INVALID) {
+        return E_NOT_OK;
+    }
+
+    /* only sockets handed out so far */
+    if ((uint32)id > __atomic_load_n(&suite_state.socket_id, __ATOMIC_RELAXED)) {
+        __atomic_fetch_add(&suite_state.torn, 1u, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&suite_state.sent, 1u, __ATOMIC_RELAXED);
+    return E_OK;
+}
+
+/* remotes used by the control thread carry their port in the address */
+static uint16 suite_remote_port(uint32 addr)
+{
+    return (uint16)((addr * 7u) + 1u);
+}
+
+Std_ReturnType TcpIp_UdpTransmit(
+        TcpIp_SocketIdType          id,
+        const uint8*                data,
+        const TcpIp_SockAddrType*   remote,
+        uint16                      len
+    )
+{
+    const TcpIp_SockAddrInetType* inet = (const TcpIp_SockAddrInetType*)remote;
+
+    /* either wildcard or a whole remote, never parts of two */
+    if ((inet->domain != TCPIP_AF_INET)
+    ||  ((inet->addr[0] == TCPIP_IPADDR_ANY) != (inet->port == TCPIP_PORT_ANY))
+    ||  ((inet->addr[0] != TCPIP_IPADDR_ANY) && (inet->port != suite_remote_port(inet->addr[0])))) {
+        __atomic_fetch_add(&suite_state.torn, 1u, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&suite_state.sent, 1u, __ATOMIC_RELAXED);
+    return E_OK;
+}
+
+static BufReq_ReturnType PduR_SoAdIfStartOfReception(
+        PduIdType               id,
+        const PduInfoType*      info,
+        PduLengthType           len,
+        PduLengthType*          buf_len
+    )
+{
+    *buf_len = (PduLengthType)0xffffu;
+    return BUFREQ_OK;
+}
+
+static BufReq_ReturnType PduR_SoAdIfCopyRxData(
+        PduIdType               id,
+        const PduInfoType*      info,
+        PduLengthType*          buf_len
+    )
+{
+    *buf_len = (PduLengthType)0xffffu;
+    return BUFREQ_OK;
+}
+
+static void PduR_SoAdTpRxIndication_If(
+        PduIdType               id,
+        Std_ReturnType          result
+    )
+{
+}
+
+const SoAd_TpRxType suite_if = {
+        .rx_indication      = PduR_SoAdTpRxIndication_If,
+        .copy_rx_data       = PduR_SoAdIfCopyRxData,
+        .start_of_reception = PduR_SoAdIfStartOfReception,
+};
+
+static void suite_if_tx_confirmation(
+        PduIdType               id
+    )
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    suite_state.confirmed++;
+    if (suite_state.resend == TRUE) {
+        suite_state.resend = FALSE;
+        CU_ASSERT_EQUAL(SoAd_IfTransmit(id, &info), E_OK);
+    }
+}
+
+const SoAd_IfTxType suite_if_tx = {
+        .tx_confirmation    = suite_if_tx_confirmation,
+};
+
+const TcpIp_SockAddrInetType socket_remote_any_v4 = {
+    .domain  = TCPIP_AF_INET,
+    .addr[0] = TCPIP_IPADDR_ANY,
+    .port    = TCPIP_PORT_ANY,
+};
+
+const TcpIp_SockAddrInetType socket_remote_server_v4 = {
+    .domain  = TCPIP_AF_INET,
+    .addr[0] = 0x0a000001u,
+    .port    = 8002,
+};
+
+const SoAd_SoGrpConfigType           socket_group_1 = {
+    .localport = 8001,
+    .localaddr = TCPIP_LOCALADDRID_ANY,
+    .domain    = TCPIP_AF_INET,
+    .protocol  = TCPIP_IPPROTO_UDP,
+    .automatic = TRUE,
+    .initiate  = FALSE,
+    .socket_route_id = SOCKET_ROUTE1,
+};
+
+const SoAd_SoGrpConfigType           socket_group_2 = {
+    .localport = 8002,
+    .localaddr = TCPIP_LOCALADDRID_ANY,
+    .domain    = TCPIP_AF_INET,
+    .protocol  = TCPIP_IPPROTO_TCP,
+    .automatic = TRUE,
+    .initiate  = FALSE,
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+};
+
+const SoAd_SoGrpConfigType           socket_group_3 = {
+    .localport = TCPIP_PORT_ANY,
+    .localaddr = TCPIP_LOCALADDRID_ANY,
+    .domain    = TCPIP_AF_INET,
+    .protocol  = TCPIP_IPPROTO_TCP,
+    .automatic = TRUE,
+    .initiate  = TRUE,
+    .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+};
+
+const SoAd_SocketRouteType           socket_route_1 = {
+        .header_id = SOAD_PDUHEADERID_INVALID,
+        .destination = {
+                .upper      = &suite_if,
+                .pdu        = 0u
+        }
+};
+
+#define SOCKET_GRP1_CONN(index)                                              \
+    {                                                                        \
+        .group  = SOCKET_GRP1,                                               \
+        .remote = (const TcpIp_SockAddrType*)&socket_remote_any_v4,          \
+        .socket_route_id = SOAD_SOCKETROUTEID_INVALID,                       \
+    }
+
+const SoAd_SoConConfigType           socket_group_1_conns[SOAD_CFG_CONNECTION_COUNT] = {
+    SOCKET_GRP1_CONN(0),
+    SOCKET_GRP1_CONN(1),
+    SOCKET_GRP1_CONN(2),
+    SOCKET_GRP1_CONN(3),
+    {
+        .group  = SOCKET_GRP2,
+        .remote = (const TcpIp_SockAddrType*)&socket_remote_any_v4,
+        .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    },
+    {
+        .group  = SOCKET_GRP2,
+        .remote = (const TcpIp_SockAddrType*)&socket_remote_any_v4,
+        .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    },
+    {
+        .group  = SOCKET_GRP3,
+        .remote = (const TcpIp_SockAddrType*)&socket_remote_server_v4,
+        .socket_route_id = SOAD_SOCKETROUTEID_INVALID,
+    },
+};
+
+#define PDU_ROUTE(index)                                                     \
+    {                                                                        \
+        .pdu_id = (index),                                                   \
+        .destination = {                                                     \
+                .header_id  = SOAD_PDUHEADERID_INVALID,                      \
+                .connection = (index),                                       \
+                .routing_groups = ((index) & 1u) ? (1u << ROUTING_GRP1) : 0u, \
+        },                                                                   \
+    }
+
+#define PDU_ROUTE_TCP(index, con)                                            \
+    {                                                                        \
+        .pdu_id = (index),                                                   \
+        .destination = {                                                     \
+                .header_id  = SOAD_PDUHEADERID_INVALID,                      \
+                .connection = (con),                                         \
+        },                                                                   \
+    }
+
+const SoAd_PduRouteType              pdu_routes[SOAD_CFG_PDUROUTE_COUNT] = {
+    PDU_ROUTE(0u),
+    PDU_ROUTE(1u),
+    PDU_ROUTE(2u),
+    PDU_ROUTE(3u),
+    {
+        .pdu_id   = SUITE_ROUTES,
+        .upper_if = &suite_if_tx,
+        .destination = {
+                .header_id  = SOAD_PDUHEADERID_INVALID,
+                .connection = 0u,
+        },
+    },
+    PDU_ROUTE_TCP(SUITE_ROUTES_TCP + 0u, SOCKET_GRP2_CON1),
+    PDU_ROUTE_TCP(SUITE_ROUTES_TCP + 1u, SOCKET_GRP2_CON2),
+    PDU_ROUTE_TCP(SUITE_ROUTES_TCP + 2u, SOCKET_GRP3_CON1),
+};
+
+const SoAd_ConfigType config = {
+    .groups = {
+        [SOCKET_GRP1] = &socket_group_1,
+        [SOCKET_GRP2] = &socket_group_2,
+        [SOCKET_GRP3] = &socket_group_3,
+    },
+
+    .connections = {
+        &socket_group_1_conns[0],
+        &socket_group_1_conns[1],
+        &socket_group_1_conns[2],
+        &socket_group_1_conns[3],
+        &socket_group_1_conns[SOCKET_GRP2_CON1],
+        &socket_group_1_conns[SOCKET_GRP2_CON2],
+        &socket_group_1_conns[SOCKET_GRP3_CON1],
+    },
+
+    .socket_routes     = {
+        [SOCKET_ROUTE1] = &socket_route_1,
+    },
+
+    .pdu_routes        = {
+        &pdu_routes[0],
+        &pdu_routes[1],
+        &pdu_routes[2],
+        &pdu_routes[3],
+        &pdu_routes[4],
+        &pdu_routes[5],
+        &pdu_routes[6],
+        &pdu_routes[7],
+    },
+
+    .routing_init = 1u << ROUTING_GRP1,
+};
+
+int suite_init(void)
+{
+    memset(&suite_state, 0, sizeof(suite_state));
+    SoAd_Init(&config);
+    return 0;
+}
+
+int suite_clean(void)
+{
+    return 0;
+}
+
+static void* suite_transmitter(void* arg)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+    PduIdType   pdu     = (PduIdType)(size_t)arg;
+
+    while (__atomic_load_n(&suite_state.stop, __ATOMIC_RELAXED) == 0u) {
+        (void)SoAd_IfTransmit(suite_state.route_first + (pdu % suite_state.route_count), &info);
+        pdu++;
+    }
+    return NULL;
+}
+
+static void suite_transmitters_start(pthread_t* threads, PduIdType first, PduIdType count)
+{
+    int index;
+
+    suite_state.route_first = first;
+    suite_state.route_count = count;
+    for (index = 0; index < SUITE_TRANSMITTERS; ++index) {
+        CU_ASSERT_EQUAL_FATAL(pthread_create(&threads[index], NULL, suite_transmitter, (void*)(size_t)index), 0);
+    }
+}
+
+static void suite_transmitters_stop(pthread_t* threads)
+{
+    int index;
+
+    __atomic_store_n(&suite_state.stop, 1u, __ATOMIC_RELAXED);
+    for (index = 0; index < SUITE_TRANSMITTERS; ++index) {
+        CU_ASSERT_EQUAL(pthread_join(threads[index], NULL), 0);
+    }
+}
+
+void main_test_concurrent_transmit(void)
+{
+    pthread_t              threads[SUITE_TRANSMITTERS];
+    TcpIp_SockAddrInetType remote = socket_remote_any_v4;
+    uint8                  buf[4] = {0};
+    uint32                 round;
+    SoAd_SoConIdType       id;
+
+    SoAd_MainFunction();
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->groups[SOCKET_GRP1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    suite_transmitters_start(threads, 0u, SUITE_ROUTES);
+
+    for (round = 0u; round < SUITE_ROUNDS; ++round) {
+        /* datagrams from new remotes bring the connections online */
+        for (id = 0u; id < SUITE_ROUTES; ++id) {
+            remote.addr[0] = 0x0a000000u + (round * SOAD_CFG_CONNECTION_COUNT) + id;
+            remote.port    = suite_remote_port(remote.addr[0]);
+            SoAd_RxIndication(SoAd_Instance->groups[SOCKET_GRP1].socket_id
+                            , &remote.base
+                            , buf
+                            , sizeof(buf));
+        }
+
+        if ((round % 8u) == 0u) {
+            (void)SoAd_DisableRouting(ROUTING_GRP1);
+        } else if ((round % 8u) == 4u) {
+            (void)SoAd_EnableRouting(ROUTING_GRP1);
+        }
+        SoAd_MainFunction();
+
+        /* let the transmitters run even on a single core */
+        (void)sched_yield();
+
+        /* and back to a wildcard for the next round */
+        for (id = 0u; id < SUITE_ROUTES; ++id) {
+            CU_ASSERT_EQUAL(SoAd_Instance->connections[id].state, SOAD_SOCON_ONLINE);
+            (void)SoAd_SetRemoteAddr(id, &socket_remote_any_v4.base);
+        }
+    }
+
+    suite_transmitters_stop(threads);
+
+    CU_ASSERT_EQUAL(suite_state.det_errors, 0u);
+    CU_ASSERT_EQUAL(suite_state.torn, 0u);
+    CU_ASSERT_NOT_EQUAL(suite_state.sent, 0u);
+}
+
+void main_test_concurrent_tcp(void)
+{
+    pthread_t              threads[SUITE_TRANSMITTERS];
+    TcpIp_SockAddrInetType remote = socket_remote_any_v4;
+    TcpIp_SocketIdType     listen;
+    TcpIp_SocketIdType     socket_id;
+    uint32                 round;
+    SoAd_SoConIdType       id;
+
+    SoAd_MainFunction();
+    listen = SoAd_Instance->groups[SOCKET_GRP2].socket_id;
+    CU_ASSERT_NOT_EQUAL_FATAL(listen, TCPIP_SOCKETID_INVALID);
+    CU_ASSERT_NOT_EQUAL_FATAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id, TCPIP_SOCKETID_INVALID);
+
+    suite_transmitters_start(threads, SUITE_ROUTES_TCP, 3u);
+
+    for (round = 0u; round < SUITE_ROUNDS; ++round) {
+        /* server connections keep their peer, but get a fresh socket from each accept */
+        for (id = SOCKET_GRP2_CON1; id <= SOCKET_GRP2_CON2; ++id) {
+            remote.addr[0] = 0x0b000000u + id;
+            remote.port    = suite_remote_port(remote.addr[0]);
+            socket_id      = (TcpIp_SocketIdType)__atomic_add_fetch(&suite_state.socket_id, 1u, __ATOMIC_RELAXED);
+            CU_ASSERT_EQUAL(SoAd_TcpAccepted(listen, socket_id, &remote.base), E_OK);
+            CU_ASSERT_EQUAL(SoAd_Instance->connections[id].state, SOAD_SOCON_ONLINE);
+        }
+
+        /* the client was reopened by the previous main function */
+        socket_id = SoAd_Instance->connections[SOCKET_GRP3_CON1].socket_id;
+        CU_ASSERT_NOT_EQUAL(socket_id, TCPIP_SOCKETID_INVALID);
+        SoAd_TcpConnected(socket_id);
+        CU_ASSERT_EQUAL(SoAd_Instance->connections[SOCKET_GRP3_CON1].state, SOAD_SOCON_ONLINE);
+
+        SoAd_MainFunction();
+        (void)sched_yield();
+
+        /* peers close every connection, the main function reopens them */
+        for (id = SOCKET_GRP2_CON1; id <= SOCKET_GRP3_CON1; ++id) {
+            SoAd_TcpIpEvent(SoAd_Instance->connections[id].socket_id, TCPIP_TCP_CLOSED);
+            CU_ASSERT_NOT_EQUAL(SoAd_Instance->connections[id].state, SOAD_SOCON_ONLINE);
+        }
+        SoAd_MainFunction();
+    }
+
+    suite_transmitters_stop(threads);
+
+    CU_ASSERT_EQUAL(suite_state.det_errors, 0u);
+    CU_ASSERT_EQUAL(suite_state.torn, 0u);
+    CU_ASSERT_NOT_EQUAL(suite_state.sent, 0u);
+}
+
+void main_add_concurrent_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "transmit"          , main_test_concurrent_transmit);
+    CU_add_test(suite, "tcp"               , main_test_concurrent_tcp);
+}
+
+void main_test_confirm_mainfunction(void)
+{
+    TcpIp_SockAddrInetType remote = socket_remote_any_v4;
+    uint8                  data[8] = {0};
+    PduInfoType            info    = { data, sizeof(data) };
+
+    SoAd_MainFunction();
+    remote.addr[0] = 0x0a000001u;
+    remote.port    = suite_remote_port(remote.addr[0]);
+    SoAd_RxIndication(SoAd_Instance->groups[SOCKET_GRP1].socket_id
+                    , &remote.base
+                    , data
+                    , sizeof(data));
+    CU_ASSERT_EQUAL_FATAL(SoAd_Instance->connections[0].state, SOAD_SOCON_ONLINE);
+
+    /* without in-flight tracking direct sends are confirmed from the main function */
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(SUITE_ROUTES, &info), E_OK);
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(SUITE_ROUTES, &info), E_OK);
+    CU_ASSERT_EQUAL(suite_state.confirmed, 0u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.confirmed, 2u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.confirmed, 2u);
+}
+
+void main_test_confirm_resend(void)
+{
+    uint8       data[8] = {0};
+    PduInfoType info    = { data, sizeof(data) };
+
+    /* a send from the confirmation waits for the next main function */
+    suite_state.resend = TRUE;
+    CU_ASSERT_EQUAL(SoAd_IfTransmit(SUITE_ROUTES, &info), E_OK);
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.confirmed, 3u);
+
+    SoAd_MainFunction();
+    CU_ASSERT_EQUAL(suite_state.confirmed, 4u);
+}
+
+void main_add_confirm_suite(CU_pSuite suite)
+{
+    CU_add_test(suite, "mainfunction"      , main_test_confirm_mainfunction);
+    CU_add_test(suite, "resend"            , main_test_confirm_resend);
+}
+
+int main(void)
+{
+    CU_pSuite suite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+      return CU_get_error();
+
+    suite = CU_add_suite("Suite_Concurrent", suite_init, suite_clean);
+    main_add_concurrent_suite(suite);
+
+    suite = CU_add_suite("Suite_Confirm", suite_init, suite_clean);
+    main_add_confirm_suite(suite);
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+    /* Run results and output to files */
+    CU_automated_run_tests();
+    CU_list_tests_to_file();
+
+    CU_cleanup_registry();
+    return CU_get_error();
+}
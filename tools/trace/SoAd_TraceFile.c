@@ -0,0 +1,115 @@
+/* Copyright (C) 2015 Joakim Plate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @ingroup SoAd
+ */
+
+#include "SoAd_TraceFile.h"
+
+#include <string.h>
+
+static const char SoAd_TraceFile_Magic[7] = { 'S', 'O', 'A', 'D', 'T', 'R', 'C' };
+
+static void SoAd_TraceFile_Put16(uint8_t* data, uint16_t value)
+{
+    data[0] = (uint8_t)(value >> 8u);
+    data[1] = (uint8_t)(value);
+}
+
+static void SoAd_TraceFile_Put32(uint8_t* data, uint32_t value)
+{
+    SoAd_TraceFile_Put16(&data[0], (uint16_t)(value >> 16u));
+    SoAd_TraceFile_Put16(&data[2], (uint16_t)(value));
+}
+
+static uint16_t SoAd_TraceFile_Get16(const uint8_t* data)
+{
+    return (uint16_t)(((uint16_t)data[0] << 8u) | data[1]);
+}
+
+static uint32_t SoAd_TraceFile_Get32(const uint8_t* data)
+{
+    return ((uint32_t)SoAd_TraceFile_Get16(&data[0]) << 16u) | SoAd_TraceFile_Get16(&data[2]);
+}
+
+int SoAd_TraceFile_WriteHeader(FILE* file, const SoAd_TraceFileHeaderType* header)
+{
+    uint8_t data[SOAD_TRACEFILE_HEADER_SIZE];
+
+    memcpy(data, SoAd_TraceFile_Magic, sizeof(SoAd_TraceFile_Magic));
+    data[7] = SOAD_TRACEFILE_VERSION;
+    SoAd_TraceFile_Put32(&data[8] , header->core);
+    SoAd_TraceFile_Put32(&data[12], header->lost);
+
+    return fwrite(data, sizeof(data), 1u, file) == 1u ? 0 : -1;
+}
+
+int SoAd_TraceFile_WriteRecord(FILE* file, const SoAd_TraceFileRecordType* record)
+{
+    uint8_t data[SOAD_TRACEFILE_RECORD_SIZE];
+
+    SoAd_TraceFile_Put32(&data[0] , record->timestamp);
+    data[4] = record->point;
+    data[5] = record->result;
+    SoAd_TraceFile_Put16(&data[6] , record->connection);
+    SoAd_TraceFile_Put16(&data[8] , record->route);
+    SoAd_TraceFile_Put16(&data[10], record->length);
+
+    return fwrite(data, sizeof(data), 1u, file) == 1u ? 0 : -1;
+}
+
+int SoAd_TraceFile_ReadHeader(FILE* file, SoAd_TraceFileHeaderType* header)
+{
+    uint8_t data[SOAD_TRACEFILE_HEADER_SIZE];
+
+    if (fread(data, sizeof(data), 1u, file) != 1u) {
+        return -1;
+    }
+
+    if ((memcmp(data, SoAd_TraceFile_Magic, sizeof(SoAd_TraceFile_Magic)) != 0)
+    ||  (data[7] != SOAD_TRACEFILE_VERSION)) {
+        return -1;
+    }
+
+    header->core = SoAd_TraceFile_Get32(&data[8]);
+    header->lost = SoAd_TraceFile_Get32(&data[12]);
+    return 0;
+}
+
+int SoAd_TraceFile_ReadRecord(FILE* file, SoAd_TraceFileRecordType* record)
+{
+    uint8_t data[SOAD_TRACEFILE_RECORD_SIZE];
+    size_t  len = fread(data, 1u, sizeof(data), file);
+
+    if (len == 0u && feof(file)) {
+        return 1;
+    }
+
+    if (len != sizeof(data)) {
+        return -1;
+    }
+
+    record->timestamp  = SoAd_TraceFile_Get32(&data[0]);
+    record->point      = data[4];
+    record->result     = data[5];
+    record->connection = SoAd_TraceFile_Get16(&data[6]);
+    record->route      = SoAd_TraceFile_Get16(&data[8]);
+    record->length     = SoAd_TraceFile_Get16(&data[10]);
+    return 0;
+}
@@ -0,0 +1,83 @@
+/* Copyright (C) 2015 Joakim Plate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @ingroup SoAd
+ *
+ * Trace file written from events drained with SoAd_GetTraceEvents().
+ *
+ * All fields are big endian. The file starts with a 16 byte header:
+ *
+ *  offset | size | field
+ *  -------|------|-----------------------------------------------
+ *       0 |    7 | magic "SOADTRC"
+ *       7 |    1 | format version, SOAD_TRACEFILE_VERSION
+ *       8 |    4 | core the ring was drained from
+ *      12 |    4 | events lost before the drain
+ *
+ * It is followed by any number of 12 byte records, oldest first:
+ *
+ *  offset | size | field
+ *  -------|------|-----------------------------------------------
+ *       0 |    4 | timestamp, SOAD_CFG_TRACE_TIMESTAMP() units
+ *       4 |    1 | point, SOAD_TRACE_* or'ed with SOAD_TRACE_FLAG_EXIT
+ *       5 |    1 | result
+ *       6 |    2 | connection
+ *       8 |    2 | route
+ *      10 |    2 | length
+ */
+
+#ifndef SOAD_TRACEFILE_H_
+#define SOAD_TRACEFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SOAD_TRACEFILE_VERSION      1u
+#define SOAD_TRACEFILE_HEADER_SIZE  16u
+#define SOAD_TRACEFILE_RECORD_SIZE  12u
+
+typedef struct {
+    uint32_t    core;
+    uint32_t    lost;
+} SoAd_TraceFileHeaderType;
+
+typedef struct {
+    uint32_t    timestamp;
+    uint8_t     point;
+    uint8_t     result;
+    uint16_t    connection;
+    uint16_t    route;
+    uint16_t    length;
+} SoAd_TraceFileRecordType;
+
+/**
+ * @brief Functions return 0 on success, -1 on i/o errors or a malformed file
+ * @{
+ */
+int SoAd_TraceFile_WriteHeader(FILE* file, const SoAd_TraceFileHeaderType* header);
+int SoAd_TraceFile_WriteRecord(FILE* file, const SoAd_TraceFileRecordType* record);
+int SoAd_TraceFile_ReadHeader(FILE* file, SoAd_TraceFileHeaderType* header);
+
+/**
+ * @brief Read the next record, returns 1 at the end of the file
+ */
+int SoAd_TraceFile_ReadRecord(FILE* file, SoAd_TraceFileRecordType* record);
+/** @} */
+
+#endif
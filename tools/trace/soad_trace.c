@@ -0,0 +1,101 @@
+/* Copyright (C) 2015 Joakim Plate
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file
+ * @ingroup SoAd
+ *
+ * Print a trace file written with SoAd_TraceFile_Write*() as text, one
+ * event per line. Exit events also show the time since the matching
+ * entry event.
+ */
+
+#include "SoAd_TraceFile.h"
+
+#include <stdio.h>
+
+/* values of SOAD_TRACE_* in SoAd.h */
+static const char* const soad_trace_points[] = {
+    "RxIndication",
+    "IfTransmit",
+    "TpTransmit",
+    "MainFunction",
+    "State",
+};
+
+#define SOAD_TRACE_POINTS       (sizeof(soad_trace_points) / sizeof(soad_trace_points[0]))
+#define SOAD_TRACE_POINT_COUNT  4u  /**< points with entry and exit events */
+#define SOAD_TRACE_FLAG_EXIT    0x80u
+
+int main(int argc, char* argv[])
+{
+    SoAd_TraceFileHeaderType header;
+    SoAd_TraceFileRecordType record;
+    uint32_t                 enter[SOAD_TRACE_POINTS] = {0u};
+    uint8_t                  point;
+    FILE*                    file;
+    int                      res;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    if (SoAd_TraceFile_ReadHeader(file, &header) != 0) {
+        fprintf(stderr, "%s: not a SoAd trace file\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    printf("# core %u, %u events lost\n", (unsigned)header.core, (unsigned)header.lost);
+
+    while ((res = SoAd_TraceFile_ReadRecord(file, &record)) == 0) {
+        point = record.point & (uint8_t)~SOAD_TRACE_FLAG_EXIT;
+
+        printf("%10u %-12s %-5s con %3u route %5u len %5u res %u"
+              , (unsigned)record.timestamp
+              , point < SOAD_TRACE_POINTS ? soad_trace_points[point] : "?"
+              , (record.point & SOAD_TRACE_FLAG_EXIT) ? "exit"
+              : point < SOAD_TRACE_POINT_COUNT        ? "enter" : ""
+              , (unsigned)record.connection
+              , (unsigned)record.route
+              , (unsigned)record.length
+              , (unsigned)record.result);
+
+        if (point < SOAD_TRACE_POINT_COUNT) {
+            if (record.point & SOAD_TRACE_FLAG_EXIT) {
+                printf(" took %u", (unsigned)(record.timestamp - enter[point]));
+            } else {
+                enter[point] = record.timestamp;
+            }
+        }
+        printf("\n");
+    }
+
+    fclose(file);
+    if (res < 0) {
+        fprintf(stderr, "%s: truncated record\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}